@@ -0,0 +1,158 @@
+#include "binary_point_file.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#define BINARY_POINT_FILE_MAGIC		"QHPT"
+#define BINARY_POINT_FILE_VERSION	1
+#define BINARY_POINT_FILE_BLOCK		(1 << 16)
+
+static size_t componentSize(uint32_t type)
+{
+	switch (type)
+	{
+	case BinaryPointFile::Float32: return sizeof(float);
+	case BinaryPointFile::Float64: return sizeof(double);
+	case BinaryPointFile::Quantized16: return sizeof(uint16_t);
+	}
+
+	return 0;
+}
+
+bool BinaryPointFile::open(const std::string& filename)
+{
+	close();
+
+	if (!_file.open(filename))
+		return false;
+
+	const Header* header = (const Header*)_file.data();
+
+	// Validate the header
+	if (_file.size() < sizeof(Header)
+		|| memcmp(header->magic, BINARY_POINT_FILE_MAGIC, 4)
+		|| header->version != BINARY_POINT_FILE_VERSION
+		|| componentSize(header->type) == 0
+		|| (_file.size() - sizeof(Header)) / (3 * componentSize(header->type)) < header->count)
+	{
+		_file.close();
+		return false;
+	}
+
+	_header = header;
+
+	return true;
+}
+
+void BinaryPointFile::decode(long long first, int count, gk::Point* points) const
+{
+	switch (_header->type)
+	{
+	case Float32:
+	{
+		const float* p = (const float*)data() + first * 3;
+		for (int i = 0; i < count; ++i, p += 3)
+			points[i] = gk::Point(p[0], p[1], p[2]);
+		break;
+	}
+
+	case Float64:
+	{
+		const double* p = (const double*)data() + first * 3;
+		for (int i = 0; i < count; ++i, p += 3)
+			points[i] = gk::Point((float)p[0], (float)p[1], (float)p[2]);
+		break;
+	}
+
+	case Quantized16:
+	{
+		const uint16_t* q = (const uint16_t*)data() + first * 3;
+		const double* s = _header->scale;
+		const double* o = _header->offset;
+
+		for (int i = 0; i < count; ++i, q += 3)
+			points[i] = gk::Point(
+			(float)(o[0] + q[0] * s[0]),
+			(float)(o[1] + q[1] * s[1]),
+			(float)(o[2] + q[2] * s[2]));
+		break;
+	}
+	}
+}
+std::vector<gk::Point> BinaryPointFile::decode() const
+{
+	std::vector<gk::Point> points((size_t)count());
+
+	if (!points.empty())
+		decode(0, (int)points.size(), &points[0]);
+
+	return points;
+}
+
+bool BinaryPointFile::write(const std::string& filename, const gk::Point* points, long long count, Type type)
+{
+	FILE* file = fopen(filename.c_str(), "wb");
+	if (!file)
+		return false;
+
+	Header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, BINARY_POINT_FILE_MAGIC, 4);
+	header.version = BINARY_POINT_FILE_VERSION;
+	header.type = type;
+	header.count = (uint64_t)count;
+
+	// Quantization range: the point set's bounding box
+	if (type == Quantized16 && count > 0)
+	{
+		gk::BBox bbox;
+		for (long long i = 0; i < count; ++i)
+			bbox.Union(points[i]);
+
+		for (int c = 0; c < 3; ++c)
+		{
+			header.offset[c] = bbox.pMin[c];
+			header.scale[c] = (bbox.pMax[c] > bbox.pMin[c]) ? ((double)bbox.pMax[c] - bbox.pMin[c]) / 65535.0 : 1.0;
+		}
+	}
+
+	bool success = fwrite(&header, sizeof(header), 1, file) == 1;
+
+	if (type == Float32)
+	{
+		success = success && (count == 0 || fwrite(points, sizeof(gk::Point), (size_t)count, file) == (size_t)count);
+	}
+	else
+	{
+		// Convert and write by blocks
+		std::vector<double> doubles;
+		std::vector<uint16_t> quantized;
+
+		for (long long first = 0; success && first < count; first += BINARY_POINT_FILE_BLOCK)
+		{
+			int n = (int)std::min<long long>(BINARY_POINT_FILE_BLOCK, count - first);
+
+			if (type == Float64)
+			{
+				doubles.resize(n * 3);
+				for (int i = 0; i < n; ++i)
+					for (int c = 0; c < 3; ++c)
+						doubles[i * 3 + c] = points[first + i][c];
+
+				success = fwrite(&doubles[0], sizeof(double), doubles.size(), file) == doubles.size();
+			}
+			else
+			{
+				quantized.resize(n * 3);
+				for (int i = 0; i < n; ++i)
+					for (int c = 0; c < 3; ++c)
+						quantized[i * 3 + c] = (uint16_t)std::min(65535.0, std::max(0.0, (points[first + i][c] - header.offset[c]) / header.scale[c] + 0.5));
+
+				success = fwrite(&quantized[0], sizeof(uint16_t), quantized.size(), file) == quantized.size();
+			}
+		}
+	}
+
+	return (fclose(file) == 0) && success;
+}
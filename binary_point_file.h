@@ -0,0 +1,79 @@
+#ifndef BINARYPOINTFILE_H
+#define BINARYPOINTFILE_H
+
+#include "mapped_file.h"
+
+#include <Geometry.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//! Compact binary point cloud file, read through a memory mapping.
+//! Layout (little endian): a fixed-size header followed by the packed point components,
+//! either float3, double3, or 16-bit quantized triplets decoded as offset + q * scale.
+class BinaryPointFile
+{
+public:
+
+	//! Point component types.
+	enum Type
+	{
+		Float32 = 0,
+		Float64 = 1,
+		Quantized16 = 2
+	};
+
+	//! File header.
+	struct Header
+	{
+		char magic[4];			//! "QHPT"
+		uint32_t version;		//! Format version
+		uint32_t type;			//! Point component type
+		uint32_t reserved;		//! Padding
+		uint64_t count;			//! Point count
+		double scale[3];		//! Quantization scale (quantized types only)
+		double offset[3];		//! Quantization offset (quantized types only)
+	};
+
+private:
+
+	//! Mapped file.
+	MappedFile _file;
+	//! Mapped header.
+	const Header* _header;
+
+public:
+
+	BinaryPointFile() : _header(nullptr) {}
+
+	//! Map the specified point file.
+	//! Returns false if the file could not be mapped or is not a valid point file.
+	bool open(const std::string& filename);
+	//! Unmap the current point file.
+	void close() { _file.close(); _header = nullptr; }
+
+	bool isOpen() const { return _header != nullptr; }
+
+	Type type() const { return (Type)_header->type; }
+	long long count() const { return (long long)_header->count; }
+
+	//! Get a zero-copy pointer to the mapped points (float3 files only, nullptr otherwise).
+	const gk::Point* points() const { return (_header->type == Float32) ? (const gk::Point*)data() : nullptr; }
+
+	//! Decode the specified point range.
+	void decode(long long first, int count, gk::Point* points) const;
+	//! Decode all the points.
+	std::vector<gk::Point> decode() const;
+
+	//! Write the specified points into a binary point file.
+	//! Returns false if the file could not be written.
+	static bool write(const std::string& filename, const gk::Point* points, long long count, Type type = Float32);
+
+private:
+
+	//! Get the mapped point data.
+	const char* data() const { return _file.data() + sizeof(Header); }
+};
+
+#endif
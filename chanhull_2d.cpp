@@ -0,0 +1,206 @@
+#include "chanhull_2d.h"
+#include "parallel.h"
+
+#include <numeric>
+
+#define CHAN_INITIAL_GROUP_SIZE		64
+#define CHAN_LINEAR_TANGENT_SIZE	8
+
+//! Cross product of (a - o) and (b - o): positive if b is on the left of (o, a).
+static inline float cross(const gk::Vec2& o, const gk::Vec2& a, const gk::Vec2& b)
+{
+	return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+void ChanHull2d::initialize(const PointView2d& points, int count)
+{
+	clear();
+
+	_points = points;
+	_pointcount = count;
+
+	if (_pointcount == 0)
+	{
+		_done = true;
+		return;
+	}
+
+	// Find the lexicographical minimal point and insert this one into the convex hull
+	int minidx = 0;
+
+	for (int i = 1; i < _pointcount; ++i)
+	{
+		gk::Vec2 p = _points[i];
+		if (p.x < _points[minidx].x || (p.x == _points[minidx].x && p.y < _points[minidx].y))
+			minidx = i;
+	}
+
+	_hullpointsidx.push_back(minidx);
+
+	_candidates.resize(_pointcount);
+	std::iota(_candidates.begin(), _candidates.end(), 0);
+
+	createGroups(CHAN_INITIAL_GROUP_SIZE);
+}
+
+void ChanHull2d::createGroups(int groupsize)
+{
+	// Restrict the candidates to the current group hulls' vertices
+	if (!_groupsizes.empty())
+	{
+		int count = 0;
+		for (int g = 0; g < (int)_groupsizes.size(); ++g)
+			for (int slot = 0; slot < _groupsizes[g]; ++slot)
+				_candidates[count++] = _grouphulls[g * _groupsize + slot];
+
+		_candidates.resize(count);
+	}
+
+	int candidatecount = (int)_candidates.size();
+
+	_groupsize = std::min(groupsize, candidatecount);
+
+	int groupcount = (candidatecount + _groupsize - 1) / _groupsize;
+
+	_grouphulls.resize(candidatecount);
+	_groupsizes.resize(groupcount);
+
+	// Monotone chain hull of each group, stored in place of the group's points
+	parallelFor(groupcount, _threadcount, [&](int, long long begin, long long end)
+	{
+		std::vector<int> sorted;
+		std::vector<int> chain;
+
+		for (int g = (int)begin; g < (int)end; ++g)
+		{
+			int first = g * _groupsize;
+			int count = std::min(_groupsize, candidatecount - first);
+
+			sorted.assign(_candidates.begin() + first, _candidates.begin() + first + count);
+
+			std::sort(sorted.begin(), sorted.end(), [this](int i1, int i2)
+			{
+				return _points[i1].x < _points[i2].x || (_points[i1].x == _points[i2].x && _points[i1].y < _points[i2].y);
+			});
+
+			chain.clear();
+			for (int pass = 0; pass < 2; ++pass)
+			{
+				int mincount = (int)chain.size() + 1;
+
+				for (int i = 0; i < count; ++i)
+				{
+					int idx = sorted[pass ? count - 1 - i : i];
+
+					while ((int)chain.size() > mincount
+						&& cross(_points[chain[chain.size() - 2]], _points[chain.back()], _points[idx]) <= 0)
+						chain.pop_back();
+
+					chain.push_back(idx);
+				}
+
+				// Each chain's last point starts the other one
+				chain.pop_back();
+			}
+
+			// Single point (or duplicates) group
+			if (chain.empty())
+				chain.push_back(sorted[0]);
+
+			std::copy(chain.begin(), chain.end(), _grouphulls.begin() + first);
+			_groupsizes[g] = (int)chain.size();
+		}
+	});
+
+	// Locate the hull's first vertex in the group hulls
+	gk::Vec2 p0 = _points[_hullpointsidx.front()];
+
+	_lastgroup = -1;
+	_lastslot = -1;
+
+	for (int g = 0; g < groupcount && _lastgroup < 0; ++g)
+	{
+		for (int slot = 0; slot < _groupsizes[g]; ++slot)
+		{
+			gk::Vec2 p = _points[_grouphulls[g * _groupsize + slot]];
+			if (p.x == p0.x && p.y == p0.y)
+			{
+				_lastgroup = g;
+				_lastslot = slot;
+				break;
+			}
+		}
+	}
+}
+
+int ChanHull2d::getTangent(int group, const gk::Vec2& p0) const
+{
+	const int* hull = &_grouphulls[group * _groupsize];
+	int count = _groupsizes[group];
+
+	if (count <= CHAN_LINEAR_TANGENT_SIZE)
+		return getTangentLinear(group, p0);
+
+	auto vertex = [&](int slot) { return _points[hull[slot < count ? slot : slot - count]]; };
+
+	// Seen from p0, the hull vertices' directions turn clockwise along the edges p0 sees (on their right),
+	// counter-clockwise along the others: binary search the most clockwise vertex, ending the seen edges
+	auto down = [&](int slot) { return cross(vertex(slot), vertex(slot + 1), p0) < 0; };
+	auto lower = [&](int slot1, int slot2) { return cross(p0, vertex(slot2), vertex(slot1)) < 0; };
+
+	int tangent = -1;
+	int a = 0;
+	int b = count;
+	bool downa = down(0);
+
+	if (!downa && down(count - 1))
+		tangent = 0;
+
+	while (tangent < 0 && b - a > 1)
+	{
+		int c = (a + b) / 2;
+		bool downc = down(c);
+
+		if (!downc && down(c - 1))
+			tangent = c;
+		else if (downa ? (downc && lower(c, a)) : (downc || !lower(c, a)))
+		{
+			a = c;
+			downa = downc;
+		}
+		else
+			b = c;
+	}
+
+	// Check the found vertex (degenerate configurations, like p0 on the hull, fall back to a linear scan)
+	if (tangent < 0 || cross(p0, vertex(tangent), vertex(tangent + count - 1)) < 0 || cross(p0, vertex(tangent), vertex(tangent + 1)) < 0)
+		return getTangentLinear(group, p0);
+
+	// Farthest collinear vertex
+	if (cross(p0, vertex(tangent), vertex(tangent + 1)) == 0 && isBetterCandidate(p0, vertex(tangent), vertex(tangent + 1)))
+		tangent = (tangent + 1) % count;
+	else if (cross(p0, vertex(tangent), vertex(tangent + count - 1)) == 0 && isBetterCandidate(p0, vertex(tangent), vertex(tangent + count - 1)))
+		tangent = (tangent + count - 1) % count;
+
+	return tangent;
+}
+
+int ChanHull2d::getTangentLinear(int group, const gk::Vec2& p0) const
+{
+	const int* hull = &_grouphulls[group * _groupsize];
+	int count = _groupsizes[group];
+
+	int tangent = -1;
+
+	for (int slot = 0; slot < count; ++slot)
+	{
+		gk::Vec2 p = _points[hull[slot]];
+		if (p.x == p0.x && p.y == p0.y)
+			continue;
+
+		if (tangent < 0 || isBetterCandidate(p0, _points[hull[tangent]], p))
+			tangent = slot;
+	}
+
+	return tangent;
+}
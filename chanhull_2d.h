@@ -0,0 +1,194 @@
+#ifndef CHANHULL2D_H
+#define CHANHULL2D_H
+
+#include "convex_hull_2d.h"
+
+#include <algorithm>
+
+//! Chan's output sensitive 2D algorithm implementation for convex hull (O(n log h) complexity with h = hull vertex count).
+//! Points are split into groups of m points whose hulls are computed in parallel, then the hull is gift wrapped over
+//! the group hulls, each wrapping step finding the groups' tangents by binary search. The group size is squared,
+//! and the wrapping restarted, whenever the hull is found to have more than m vertices: only the previous group hulls'
+//! vertices are regrouped, the other points being interior.
+class ChanHull2d : public ConvexHull2d
+{
+private:
+
+	//! End flag.
+	bool _done;
+	//! Iteration identifier.
+	int _iterationid;
+
+	//! Hull group thread count (0: all cores).
+	int _threadcount;
+
+	//! Input points.
+	PointView2d _points;
+	int _pointcount;
+
+	//! Candidate hull vertex indices (the previous group hulls' vertices).
+	std::vector<int> _candidates;
+	//! Group size (m).
+	int _groupsize;
+	//! Group hulls' counter-clockwise point indices, group g's hull starting at g * m.
+	std::vector<int> _grouphulls;
+	//! Group hulls' vertex counts.
+	std::vector<int> _groupsizes;
+
+	//! Convex hull's point indices.
+	std::vector<int> _hullpointsidx;
+	//! Group and group hull slot of the last hull vertex.
+	int _lastgroup;
+	int _lastslot;
+
+	//! Split the candidate points into groups of the specified size, and compute their hulls.
+	//! The candidates are first restricted to the current group hulls' vertices, if any.
+	void createGroups(int groupsize);
+
+	//! Get the tangent vertex slot, from p0, of the specified group's hull: the hull vertex with no group point on
+	//! the right of (p0, vertex), the farthest one if collinear. Returns -1 if the group has no vertex apart from p0.
+	int getTangent(int group, const gk::Vec2& p0) const;
+	//! Get the tangent vertex slot by a linear scan of the specified group's hull.
+	int getTangentLinear(int group, const gk::Vec2& p0) const;
+
+	//! Returns true if candidate p2 wraps better than p1 from p0: p2 on the right of (p0, p1), or collinear and farther.
+	static bool isBetterCandidate(const gk::Vec2& p0, const gk::Vec2& p1, const gk::Vec2& p2)
+	{
+		float d = (p0.y - p1.y) * (p2.x - p0.x) + (p1.x - p0.x) * (p2.y - p0.y);
+
+		if (d == 0)
+		{
+			gk::Vec2 v01(p1.x - p0.x, p1.y - p0.y);
+			gk::Vec2 v02(p2.x - p0.x, p2.y - p0.y);
+
+			return (v02.x * v02.x + v02.y * v02.y) > (v01.x * v01.x + v01.y * v01.y);
+		}
+
+		return d < 0;
+	}
+
+public:
+
+	ChanHull2d(int threadcount = 0) : _threadcount(threadcount) { clear(); }
+	ChanHull2d(ChanHull2d&& hull) { *this = std::move(hull); }
+
+	ChanHull2d& operator=(ChanHull2d&& hull);
+
+	virtual void clear();
+
+	using ConvexHull2d::initialize;
+	virtual void initialize(const PointView2d& points, int count);
+
+	virtual int build();
+	virtual bool iterate();
+
+	virtual std::vector<int> hull() const { return _hullpointsidx; }
+};
+
+inline ChanHull2d& ChanHull2d::operator=(ChanHull2d&& hull)
+{
+	if (this != &hull)
+	{
+		_done = hull._done;
+		_iterationid = hull._iterationid;
+
+		_threadcount = hull._threadcount;
+
+		_points = std::move(hull._points);
+		_pointcount = hull._pointcount;
+
+		_candidates = std::move(hull._candidates);
+		_groupsize = hull._groupsize;
+		_grouphulls = std::move(hull._grouphulls);
+		_groupsizes = std::move(hull._groupsizes);
+
+		_hullpointsidx = std::move(hull._hullpointsidx);
+		_lastgroup = hull._lastgroup;
+		_lastslot = hull._lastslot;
+	}
+
+	return *this;
+}
+
+inline void ChanHull2d::clear()
+{
+	_hullpointsidx.clear();
+	_lastgroup = -1;
+	_lastslot = -1;
+
+	_candidates.clear();
+	_grouphulls.clear();
+	_groupsizes.clear();
+	_groupsize = 0;
+
+	_points = PointView2d();
+	_pointcount = 0;
+
+	_iterationid = -1;
+	_done = false;
+}
+
+inline int ChanHull2d::build()
+{
+	while (iterate());
+
+	return _iterationid + 1;
+}
+inline bool ChanHull2d::iterate()
+{
+	if (_done)
+		return false;
+
+	++_iterationid;
+
+	gk::Vec2 p0 = _points[_hullpointsidx.back()];
+
+	// Wrap to the best tangent of all the group hulls: the last vertex's group hull is simply followed
+	int p1group = -1;
+	int p1slot = -1;
+	int p1idx = -1;
+
+	for (int g = 0; g < (int)_groupsizes.size(); ++g)
+	{
+		int slot;
+		if (g == _lastgroup)
+			slot = (_groupsizes[g] > 1) ? (_lastslot + 1) % _groupsizes[g] : -1;
+		else
+			slot = getTangent(g, p0);
+
+		if (slot < 0)
+			continue;
+
+		int idx = _grouphulls[g * _groupsize + slot];
+		if (p1idx < 0 || isBetterCandidate(p0, _points[p1idx], _points[idx]))
+		{
+			p1group = g;
+			p1slot = slot;
+			p1idx = idx;
+		}
+	}
+
+	gk::Vec2 first = _points[_hullpointsidx.front()];
+
+	if (p1idx < 0 || (_points[p1idx].x == first.x && _points[p1idx].y == first.y))
+	{
+		_done = true;
+	}
+	else if ((int)_hullpointsidx.size() == _groupsize && _groupsizes.size() > 1)
+	{
+		// More hull vertices than the group size: square it and restart the wrapping
+		_hullpointsidx.resize(1);
+
+		createGroups((int)std::min((long long)_groupsize * _groupsize, (long long)_pointcount));
+	}
+	else
+	{
+		_hullpointsidx.push_back(p1idx);
+		_lastgroup = p1group;
+		_lastslot = p1slot;
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,67 @@
+#include "compact_hull.h"
+#include "qhull_trace.h"
+
+#define COMPACT_HULL_MAX_INDEX16	(1 << 16)
+
+//! Write the specified faces' indices, remapped, into the specified index array.
+template <typename Index>
+static void remapFaces(const std::vector<ConvexHull3d::Face>& faces, const std::vector<int>& remap, std::vector<Index>& indices)
+{
+	indices.resize(faces.size() * 3);
+
+	for (size_t f = 0; f < faces.size(); ++f)
+	{
+		indices[f * 3] = (Index)remap[faces[f].idx[0]];
+		indices[f * 3 + 1] = (Index)remap[faces[f].idx[1]];
+		indices[f * 3 + 2] = (Index)remap[faces[f].idx[2]];
+	}
+}
+
+void CompactHull::build(const PointView3d& points, int count, const std::vector<ConvexHull3d::Face>& faces, IndexWidth width)
+{
+	QHULL_TRACE("CompactHull::build");
+
+	clear();
+
+	// Flag the referenced points, then number them in input order: no sort, and a deterministic vertex order
+	std::vector<int> remap(count, -1);
+
+	for (const ConvexHull3d::Face& face : faces)
+	{
+		remap[face.idx[0]] = 0;
+		remap[face.idx[1]] = 0;
+		remap[face.idx[2]] = 0;
+	}
+
+	for (int i = 0; i < count; ++i)
+	{
+		if (remap[i] == 0)
+		{
+			remap[i] = (int)_originalindices.size();
+			_originalindices.push_back(i);
+		}
+	}
+
+	// Gather the hull vertices, straight from the input layout for packed points
+	_vertices.resize(_originalindices.size());
+
+	if (points.packed())
+	{
+		const gk::Point* packed = (const gk::Point*)points.base();
+		for (size_t v = 0; v < _originalindices.size(); ++v)
+			_vertices[v] = packed[_originalindices[v]];
+	}
+	else
+	{
+		for (size_t v = 0; v < _originalindices.size(); ++v)
+			_vertices[v] = points[_originalindices[v]];
+	}
+
+	// Re-index the faces
+	_indexsize = (width != Index32 && _vertices.size() <= COMPACT_HULL_MAX_INDEX16) ? Index16 : Index32;
+
+	if (_indexsize == Index16)
+		remapFaces(faces, remap, _indices16);
+	else
+		remapFaces(faces, remap, _indices32);
+}
@@ -0,0 +1,83 @@
+#ifndef COMPACTHULL_H
+#define COMPACTHULL_H
+
+#include "convex_hull_3d.h"
+
+#include <cstdint>
+#include <vector>
+
+//! Compact hull mesh: the hull vertices gathered out of the input point set, and the faces re-indexed into them
+//! with 16 or 32-bit indices, ready to be uploaded to the GPU or sent over the network as is.
+class CompactHull
+{
+public:
+
+	//! Face index widths.
+	enum IndexWidth
+	{
+		Auto = 0,		//! 16-bit if the vertex count allows it, 32-bit otherwise
+		Index16 = 2,	//! 16-bit, falling back to 32-bit beyond 65536 vertices
+		Index32 = 4		//! 32-bit
+	};
+
+private:
+
+	//! Hull vertices, in increasing input index order.
+	std::vector<gk::Point> _vertices;
+	//! Input index of each hull vertex.
+	std::vector<int> _originalindices;
+
+	//! Face indices into the hull vertices, 3 per face, in the selected width (the other being left empty).
+	std::vector<uint16_t> _indices16;
+	std::vector<uint32_t> _indices32;
+	int _indexsize;
+
+public:
+
+	CompactHull() : _indexsize(Index32) {}
+
+	//! Clear internal data.
+	void clear();
+
+	//! Compact the specified hull faces, indexing the specified points.
+	void build(const PointView3d& points, int count, const std::vector<ConvexHull3d::Face>& faces, IndexWidth width = Auto);
+
+	//! Get the hull vertex count.
+	int vertexCount() const { return (int)_vertices.size(); }
+	//! Get the hull vertices.
+	const std::vector<gk::Point>& vertices() const { return _vertices; }
+	//! Get the input index of each hull vertex.
+	const std::vector<int>& originalIndices() const { return _originalindices; }
+
+	//! Get the face count.
+	int faceCount() const { return (int)((_indexsize == Index16) ? _indices16.size() : _indices32.size()) / 3; }
+
+	//! Get the size of a face index, in bytes (2 or 4).
+	int indexSize() const { return _indexsize; }
+	//! Get the face indices, 3 per face, as indexSize() bytes each.
+	const void* indexData() const;
+
+	//! Get the face indices, 3 per face (16-bit width only, empty otherwise).
+	const std::vector<uint16_t>& indices16() const { return _indices16; }
+	//! Get the face indices, 3 per face (32-bit width only, empty otherwise).
+	const std::vector<uint32_t>& indices32() const { return _indices32; }
+};
+
+inline void CompactHull::clear()
+{
+	_vertices.clear();
+	_originalindices.clear();
+	_indices16.clear();
+	_indices32.clear();
+	_indexsize = Index32;
+}
+
+inline const void* CompactHull::indexData() const
+{
+	if (_indexsize == Index16)
+		return _indices16.empty() ? nullptr : &_indices16[0];
+
+	return _indices32.empty() ? nullptr : &_indices32[0];
+}
+
+#endif
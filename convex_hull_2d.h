@@ -3,8 +3,30 @@
 
 #include <Geometry.h>
 
+#include <cstddef>
 #include <vector>
 
+//! Read-only strided view on 2D points: point i is (x[i * stride], y[i * stride]), stride in floats.
+//! Lets 2D engines read projections stored within other layouts without copying them (e.g. two of a 3D point's coordinates).
+class PointView2d
+{
+private:
+
+	const float* _x;
+	const float* _y;
+	size_t _stride;
+
+public:
+
+	PointView2d() : _x(nullptr), _y(nullptr), _stride(2) {}
+	PointView2d(const gk::Vec2* points) : _x(points ? &points->x : nullptr), _y(points ? &points->y : nullptr), _stride(2) {}
+	PointView2d(const float* x, const float* y, size_t stride) : _x(x), _y(y), _stride(stride) {}
+
+	gk::Vec2 operator[](int i) const { return gk::Vec2(_x[i * _stride], _y[i * _stride]); }
+
+	bool empty() const { return _x == nullptr; }
+};
+
 //! 2D convex hull computing base class.
 class ConvexHull2d
 {
@@ -15,8 +37,11 @@ public:
 	//! Clear internal data.
 	virtual void clear() = 0;
 
+	//! Initialize the hull computing for the specified point set, read through the specified view.
+	//! The viewed points must remain valid until the hull is cleared.
+	virtual void initialize(const PointView2d& points, int count) = 0;
 	//! Initialize the hull computing for the specified point set.
-	virtual void initialize(const gk::Vec2* points, int count) = 0;
+	void initialize(const gk::Vec2* points, int count) { initialize(PointView2d(points), count); }
 
 	//! Build the point set's convex hull.
 	//! Return the number of performed iteration to build the hull.
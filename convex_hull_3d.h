@@ -3,8 +3,63 @@
 
 #include <Geometry.h>
 
+#include <cstddef>
+#include <cstring>
 #include <vector>
 
+//! Read-only strided view on 3D points: point i's three consecutive coordinates are read at base + i * stride, stride in bytes.
+//! Lets engines read positions stored within interleaved vertex buffers (position, normal, uv...) or double precision arrays without copying them.
+class PointView3d
+{
+public:
+
+	//! Coordinate types.
+	enum Type
+	{
+		Float,
+		Double
+	};
+
+private:
+
+	const char* _base;
+	size_t _stride;
+	Type _type;
+
+public:
+
+	PointView3d() : _base(nullptr), _stride(sizeof(gk::Point)), _type(Float) {}
+	PointView3d(const gk::Point* points) : _base((const char*)points), _stride(sizeof(gk::Point)), _type(Float) {}
+	PointView3d(const float* coordinates, size_t stride) : _base((const char*)coordinates), _stride(stride), _type(Float) {}
+	PointView3d(const double* coordinates, size_t stride) : _base((const char*)coordinates), _stride(stride), _type(Double) {}
+
+	gk::Point operator[](int i) const
+	{
+		const char* p = _base + i * _stride;
+
+		if (_type == Float)
+		{
+			float c[3];
+			memcpy(c, p, sizeof(c));
+
+			return gk::Point(c[0], c[1], c[2]);
+		}
+
+		double c[3];
+		memcpy(c, p, sizeof(c));
+
+		return gk::Point((float)c[0], (float)c[1], (float)c[2]);
+	}
+
+	const char* base() const { return _base; }
+	size_t stride() const { return _stride; }
+	Type type() const { return _type; }
+
+	//! Returns true if the points are packed float triples, i.e. readable as a gk::Point array.
+	bool packed() const { return _type == Float && _stride == sizeof(gk::Point); }
+	bool empty() const { return _base == nullptr; }
+};
+
 //! 3D convex hull computing base class.
 class ConvexHull3d
 {
@@ -28,8 +83,11 @@ public:
 	//! Clear internal data.
 	virtual void clear() = 0;
 
+	//! Initialize the hull computing for the specified point set, read through the specified view.
+	//! The viewed points must remain valid until the hull is cleared.
+	virtual void initialize(const PointView3d& points, int count) = 0;
 	//! Initialize the hull computing for the specified point set.
-	virtual void initialize(const gk::Point* points, int count) = 0;
+	void initialize(const gk::Point* points, int count) { initialize(PointView3d(points), count); }
 
 	//! Build the point set's convex hull.
 	//! Return the number of performed iteration to build the hull.
@@ -13,13 +13,15 @@ struct GLVertexBufferSet
 	gk::GLBuffer* indices;
 
 	unsigned int indexcount;
+	GLenum indextype;
 
 	GLVertexBufferSet()
 		:vao(nullptr),
 		positions(nullptr),
 		colors(nullptr),
 		indices(nullptr),
-		indexcount(0)
+		indexcount(0),
+		indextype(GL_UNSIGNED_INT)
 	{
 	}
 	~GLVertexBufferSet()
@@ -1,14 +1,19 @@
 #include "gl_viewer.h"
+#include "binary_point_file.h"
+#include "compact_hull.h"
+#include "hull_export.h"
+#include "qhull_trace.h"
+#include "text_point_file.h"
 
 #include <ProgramManager.h>
 #include <GL/GLTexture.h>
 #include <GL/GLBuffer.h>
 
 #include <numeric>
-#include <fstream>
 
 #define DEFAULT_POINT_COUNT		16
 #define DEFAULT_POINT_FILENAME	"points.txt"
+#define DEFAULT_HULL_FILENAME	"hull.ply"
 
 GLViewer::GLViewer(const GLCamera& camera, int windowwidth, int windowheight, bool restoreprevioussession)
 	: _camera(camera),
@@ -96,44 +101,27 @@ std::vector<Point> GLViewer::loadPoints(const std::string& filename)
 {
 	std::vector<Point> points;
 
-	std::ifstream file(filename);
+	// Binary point file
+	BinaryPointFile binaryfile;
+	if (binaryfile.open(filename))
+		return binaryfile.decode();
 
-	int i = 0;
-
-	while (!file.eof())
-	{
-		Point p;
-
-		file >> p.x;
-		file >> p.y;
-		file >> p.z;
-
-		points.push_back(p);
-
-		i++;
-	}
-
-	file.close();
+	// Text point file
+	if (!TextPointFile::read(filename, points))
+		std::cout << "Failed to read points from " << filename << std::endl;
 
 	return points;
 }
 void GLViewer::savePoints(std::vector<Point>& points, const std::string& filename)
 {
-	std::ofstream file(filename);
-
-	for (int i = 0; i < (int)points.size(); ++i)
-	{
-		Point p = points[i];
-
-		file << p.x << " ";
-		file << p.y << " ";
-		file << p.z;
-
-		if (i < ((int)points.size() - 1))
-			file << std::endl;
-	}
+	if (!TextPointFile::write(filename, points.empty() ? nullptr : &points[0], (long long)points.size()))
+		std::cout << "Failed to write points to " << filename << std::endl;
+}
 
-	file.close();
+void GLViewer::saveHull(const std::string& filename)
+{
+	if (_points.empty() || !HullExport::write(filename, &_points[0], (int)_points.size(), _qhull.hull(), HullExport::Compact | HullExport::Normals))
+		std::cout << "Failed to write hull to " << filename << std::endl;
 }
 
 void GLViewer::initGLGeometry()
@@ -233,22 +221,24 @@ void GLViewer::createGLGeometry()
 	std::vector<QHull3d::Face> hull = _qhull.hull();
 	if (!hull.empty())
 	{
+		// Only the hull vertices are uploaded, the faces being re-indexed into them with the narrowest index width
+		CompactHull compacthull;
+		compacthull.build(&_points[0], (int)_points.size(), hull);
+
+		const std::vector<gk::Point>& hullvertices = compacthull.vertices();
+		bool indices16 = compacthull.indexSize() == CompactHull::Index16;
+
 		// Hull vertices
-		colors = std::vector<gk::Vec4>(_points.size(), gk::Vec4(1, 1, 0, 1));
+		colors = std::vector<gk::Vec4>(hullvertices.size(), gk::Vec4(1, 1, 0, 1));
 
-		indices.resize(hull.size() * 3);
-		for (int i = 0; i < (int)hull.size(); ++i)
-		{
-			indices[i * 3] = (unsigned int)(hull[i].idx[0]);
-			indices[(i * 3) + 1] = (unsigned int)(hull[i].idx[1]);
-			indices[(i * 3) + 2] = (unsigned int)(hull[i].idx[2]);
-		}
+		indices.resize(hullvertices.size());
+		std::iota(indices.begin(), indices.end(), 0);
 
 		_hullglvertices = new GLVertexBufferSet();
 		_hullglvertices->vao = createGLUnmanagedVertexArray();
 		_hullglvertices->indexcount = (unsigned int)indices.size();
 
-		_hullglvertices->positions = createGLUnmanagedBuffer(GL_ARRAY_BUFFER, _points);
+		_hullglvertices->positions = createGLUnmanagedBuffer(GL_ARRAY_BUFFER, hullvertices);
 		glVertexAttribPointer(_program->attribute("vertex_position"), 3, GL_FLOAT, GL_FALSE, 0, 0);
 		glEnableVertexAttribArray(_program->attribute("vertex_position"));
 
@@ -259,23 +249,12 @@ void GLViewer::createGLGeometry()
 		_hullglvertices->indices = createGLUnmanagedBuffer(GL_ELEMENT_ARRAY_BUFFER, indices);
 
 		// Hull faces
-		std::vector<gk::Point> hullvertices;
-		hullvertices.reserve(hull.size() * 3);
-		for (int i = 0; i < (int)hull.size(); ++i)
-		{
-			hullvertices.push_back(_points[hull[i].idx[0]]);
-			hullvertices.push_back(_points[hull[i].idx[1]]);
-			hullvertices.push_back(_points[hull[i].idx[2]]);
-		}
-
 		colors = std::vector<gk::Vec4>(hullvertices.size(), gk::Vec4(1, 0, 0, 1));
 
-		indices.resize(hull.size() * 3);
-		std::iota(indices.begin(), indices.end(), 0);
-
 		_hullglfaces = new GLVertexBufferSet();
 		_hullglfaces->vao = createGLUnmanagedVertexArray();
-		_hullglfaces->indexcount = (unsigned int)indices.size();
+		_hullglfaces->indexcount = (unsigned int)compacthull.faceCount() * 3;
+		_hullglfaces->indextype = indices16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
 
 		_hullglfaces->positions = createGLUnmanagedBuffer(GL_ARRAY_BUFFER, hullvertices);
 		glVertexAttribPointer(_program->attribute("vertex_position"), 3, GL_FLOAT, GL_FALSE, 0, 0);
@@ -285,29 +264,36 @@ void GLViewer::createGLGeometry()
 		glVertexAttribPointer(_program->attribute("vertex_color"), 4, GL_FLOAT, GL_FALSE, 0, 0);
 		glEnableVertexAttribArray(_program->attribute("vertex_color"));
 
-		_hullglfaces->indices = createGLUnmanagedBuffer(GL_ELEMENT_ARRAY_BUFFER, indices);
+		if (indices16)
+			_hullglfaces->indices = createGLUnmanagedBuffer(GL_ELEMENT_ARRAY_BUFFER, compacthull.indices16());
+		else
+			_hullglfaces->indices = createGLUnmanagedBuffer(GL_ELEMENT_ARRAY_BUFFER, compacthull.indices32());
 
 		// Hull edges
-		colors = std::vector<gk::Vec4>(_points.size(), gk::Vec4(1, 1, 1, 1));
+		colors = std::vector<gk::Vec4>(hullvertices.size(), gk::Vec4(1, 1, 1, 1));
 
 		indices.resize(hull.size() * 6);
-		for (int i = 0; i < (int)hull.size(); ++i)
+		for (int i = 0; i < compacthull.faceCount(); ++i)
 		{
-			indices[i * 6] = (unsigned int)(hull[i].idx[0]);
-			indices[(i * 6) + 1] = (unsigned int)(hull[i].idx[1]);
+			unsigned int idx[3];
+			for (int k = 0; k < 3; ++k)
+				idx[k] = indices16 ? compacthull.indices16()[i * 3 + k] : compacthull.indices32()[i * 3 + k];
 
-			indices[(i * 6) + 2] = (unsigned int)(hull[i].idx[1]);
-			indices[(i * 6) + 3] = (unsigned int)(hull[i].idx[2]);
+			indices[i * 6] = idx[0];
+			indices[(i * 6) + 1] = idx[1];
 
-			indices[(i * 6) + 4] = (unsigned int)(hull[i].idx[2]);
-			indices[(i * 6) + 5] = (unsigned int)(hull[i].idx[0]);
+			indices[(i * 6) + 2] = idx[1];
+			indices[(i * 6) + 3] = idx[2];
+
+			indices[(i * 6) + 4] = idx[2];
+			indices[(i * 6) + 5] = idx[0];
 		}
 
 		_hullgledges = new GLVertexBufferSet();
 		_hullgledges->vao = createGLUnmanagedVertexArray();
 		_hullgledges->indexcount = (unsigned int)indices.size();
 
-		_hullgledges->positions = createGLUnmanagedBuffer(GL_ARRAY_BUFFER, _points);
+		_hullgledges->positions = createGLUnmanagedBuffer(GL_ARRAY_BUFFER, hullvertices);
 		glVertexAttribPointer(_program->attribute("vertex_position"), 3, GL_FLOAT, GL_FALSE, 0, 0);
 		glEnableVertexAttribArray(_program->attribute("vertex_position"));
 
@@ -321,17 +307,20 @@ void GLViewer::createGLGeometry()
 		std::vector<int> facesextremes = _qhull.getFacesExtremesIndices();
 		if (!facesextremes.empty())
 		{
-			colors = std::vector<gk::Vec4>(_points.size(), gk::Vec4(1, 1, 0, 1));
-
-			indices.resize(facesextremes.size());
+			std::vector<gk::Point> extremes(facesextremes.size());
 			for (int i = 0; i < (int)facesextremes.size(); ++i)
-				indices[i] = (unsigned int)facesextremes[i];
+				extremes[i] = _points[facesextremes[i]];
+
+			colors = std::vector<gk::Vec4>(extremes.size(), gk::Vec4(1, 1, 0, 1));
+
+			indices.resize(extremes.size());
+			std::iota(indices.begin(), indices.end(), 0);
 
 			_hullglfacesextremes = new GLVertexBufferSet();
 			_hullglfacesextremes->vao = createGLUnmanagedVertexArray();
 			_hullglfacesextremes->indexcount = (unsigned int)indices.size();
 
-			_hullglfacesextremes->positions = createGLUnmanagedBuffer(GL_ARRAY_BUFFER, _points);
+			_hullglfacesextremes->positions = createGLUnmanagedBuffer(GL_ARRAY_BUFFER, extremes);
 			glVertexAttribPointer(_program->attribute("vertex_position"), 3, GL_FLOAT, GL_FALSE, 0, 0);
 			glEnableVertexAttribArray(_program->attribute("vertex_position"));
 
@@ -345,6 +334,8 @@ void GLViewer::createGLGeometry()
 }
 void GLViewer::updateGLGeometry()
 {
+	QHULL_TRACE("updateGLGeometry");
+
 	destroyGLGeometry();
 	createGLGeometry();
 
@@ -409,6 +400,11 @@ int GLViewer::draw()
 		key('c') = 0;
 		gk::writeFramebuffer("screenshot.png");
 	}
+	if (key('e'))
+	{
+		key('e') = 0;
+		saveHull(DEFAULT_HULL_FILENAME);
+	}
 
 	// Keyboard: Camera navigation
 	if (key(SDLK_z))
@@ -502,7 +498,7 @@ int GLViewer::draw()
 	if (_hullglfaces)
 	{
 		glBindVertexArray(_hullglfaces->vao->name);
-		glDrawElements(GL_TRIANGLES, _hullglfaces->indexcount, GL_UNSIGNED_INT, 0);
+		glDrawElements(GL_TRIANGLES, _hullglfaces->indexcount, _hullglfaces->indextype, 0);
 	}
 
 	// Hull edges
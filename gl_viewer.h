@@ -71,6 +71,7 @@ private:
 	std::vector<Point> loadRandomPoints(int count);
 	std::vector<Point> loadPoints(const std::string& filename);
 	void savePoints(std::vector<Point>& points, const std::string& filename);
+	void saveHull(const std::string& filename);
 
 	void initGLGeometry();
 	void createGLGeometry();
@@ -0,0 +1,315 @@
+#include "hull_export.h"
+
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#define HULL_EXPORT_BUFFER		(1 << 22)
+#define HULL_EXPORT_MAX_RECORD	256
+
+//! Output file writing through a large buffer.
+class BufferedWriter
+{
+private:
+
+	FILE* _file;
+	std::vector<char> _buffer;
+	size_t _size;
+	bool _success;
+
+public:
+
+	BufferedWriter(const std::string& filename) : _file(fopen(filename.c_str(), "wb")), _buffer(HULL_EXPORT_BUFFER), _size(0), _success(_file != nullptr) {}
+	~BufferedWriter() { close(); }
+
+	bool isOpen() const { return _file != nullptr; }
+
+	//! Get room for a record of at most HULL_EXPORT_MAX_RECORD bytes, flushing the buffer if needed.
+	char* reserve()
+	{
+		if (_size + HULL_EXPORT_MAX_RECORD > _buffer.size())
+			flush();
+
+		return &_buffer[_size];
+	}
+	//! Commit the record written into the reserved room, up to the specified end.
+	void commit(const char* end) { _size = end - &_buffer[0]; }
+
+	void write(const void* data, size_t size)
+	{
+		char* p = reserve();
+		memcpy(p, data, size);
+		commit(p + size);
+	}
+	void write(const char* text) { write(text, strlen(text)); }
+
+	void flush()
+	{
+		if (_file && _size > 0)
+			_success = _success && fwrite(&_buffer[0], 1, _size, _file) == _size;
+
+		_size = 0;
+	}
+
+	//! Flush and close the file, returning false if any write failed.
+	bool close()
+	{
+		if (_file)
+		{
+			flush();
+			_success = (fclose(_file) == 0) && _success;
+			_file = nullptr;
+		}
+
+		return _success;
+	}
+};
+
+//! Format a float followed by the specified separator.
+static inline char* formatFloat(char* p, float f, char separator)
+{
+	p = std::to_chars(p, p + 32, f).ptr;
+	*p++ = separator;
+
+	return p;
+}
+//! Format a 1-based OBJ index.
+static inline char* formatIndex(char* p, int i)
+{
+	return std::to_chars(p, p + 16, i + 1).ptr;
+}
+
+//! Get the unit normal of the specified face.
+static gk::Vector faceNormal(const gk::Point* points, const ConvexHull3d::Face& face)
+{
+	gk::Vector n = gk::Cross(points[face.idx[1]] - points[face.idx[0]], points[face.idx[2]] - points[face.idx[0]]);
+	float length = n.Length();
+
+	return (length > 0.0f) ? n / length : gk::Vector(0.0f, 0.0f, 0.0f);
+}
+
+//! Get the exported vertex indices: the referenced vertices in order of first reference when compacting, all the points otherwise.
+//! Fills remap with each point's exported index.
+static void exportedVertices(int count, const std::vector<ConvexHull3d::Face>& faces, bool compact,
+	std::vector<int>& vertices, std::vector<int>& remap)
+{
+	vertices.clear();
+	remap.clear();
+
+	if (!compact)
+	{
+		vertices.resize(count);
+		remap.resize(count);
+		for (int i = 0; i < count; ++i)
+			vertices[i] = remap[i] = i;
+
+		return;
+	}
+
+	remap.resize(count, -1);
+	for (const ConvexHull3d::Face& face : faces)
+	{
+		for (int k = 0; k < 3; ++k)
+		{
+			int i = face.idx[k];
+			if (remap[i] < 0)
+			{
+				remap[i] = (int)vertices.size();
+				vertices.push_back(i);
+			}
+		}
+	}
+}
+
+static bool writePLY(BufferedWriter& file, const gk::Point* points, int count, const std::vector<ConvexHull3d::Face>& faces, int options)
+{
+	std::vector<int> vertices, remap;
+	exportedVertices(count, faces, (options & HullExport::Compact) != 0, vertices, remap);
+
+	// Header
+	char header[512];
+	snprintf(header, sizeof(header),
+		"ply\nformat binary_little_endian 1.0\n"
+		"element vertex %d\nproperty float x\nproperty float y\nproperty float z\n"
+		"element face %d\nproperty list uchar int vertex_indices\n%s"
+		"end_header\n",
+		(int)vertices.size(), (int)faces.size(),
+		(options & HullExport::Normals) ? "property float nx\nproperty float ny\nproperty float nz\n" : "");
+	file.write(header);
+
+	// Vertices, assuming a little endian host
+	for (int i : vertices)
+		file.write(&points[i], sizeof(gk::Point));
+
+	// Faces
+	for (const ConvexHull3d::Face& face : faces)
+	{
+		char* p = file.reserve();
+
+		*p++ = 3;
+		for (int k = 0; k < 3; ++k, p += sizeof(int32_t))
+		{
+			int32_t index = remap[face.idx[k]];
+			memcpy(p, &index, sizeof(int32_t));
+		}
+
+		if (options & HullExport::Normals)
+		{
+			gk::Vector n = faceNormal(points, face);
+			float normal[3] = { n.x, n.y, n.z };
+
+			memcpy(p, normal, sizeof(normal));
+			p += sizeof(normal);
+		}
+
+		file.commit(p);
+	}
+
+	return file.close();
+}
+
+static bool writeSTL(BufferedWriter& file, const gk::Point* points, const std::vector<ConvexHull3d::Face>& faces, int options)
+{
+	// STL has no shared vertices: compaction does not apply, and unrequested normals are left null
+	char header[80] = "qhull convex hull";
+	uint32_t facecount = (uint32_t)faces.size();
+
+	file.write(header, sizeof(header));
+	file.write(&facecount, sizeof(facecount));
+
+	for (const ConvexHull3d::Face& face : faces)
+	{
+		float facet[12] = {};
+
+		if (options & HullExport::Normals)
+		{
+			gk::Vector n = faceNormal(points, face);
+			facet[0] = n.x;
+			facet[1] = n.y;
+			facet[2] = n.z;
+		}
+
+		for (int k = 0; k < 3; ++k)
+			memcpy(&facet[3 + 3 * k], &points[face.idx[k]], sizeof(gk::Point));
+
+		char* p = file.reserve();
+		memcpy(p, facet, sizeof(facet));
+		memset(p + sizeof(facet), 0, sizeof(uint16_t));		// Attribute byte count
+		file.commit(p + sizeof(facet) + sizeof(uint16_t));
+	}
+
+	return file.close();
+}
+
+static bool writeOBJ(BufferedWriter& file, const gk::Point* points, int count, const std::vector<ConvexHull3d::Face>& faces, int options)
+{
+	std::vector<int> vertices, remap;
+	exportedVertices(count, faces, (options & HullExport::Compact) != 0, vertices, remap);
+
+	file.write("# qhull convex hull\n");
+
+	// Vertices
+	for (int i : vertices)
+	{
+		char* p = file.reserve();
+
+		*p++ = 'v';
+		*p++ = ' ';
+		p = formatFloat(p, points[i].x, ' ');
+		p = formatFloat(p, points[i].y, ' ');
+		p = formatFloat(p, points[i].z, '\n');
+
+		file.commit(p);
+	}
+
+	// Normals
+	if (options & HullExport::Normals)
+	{
+		for (const ConvexHull3d::Face& face : faces)
+		{
+			gk::Vector n = faceNormal(points, face);
+			char* p = file.reserve();
+
+			*p++ = 'v';
+			*p++ = 'n';
+			*p++ = ' ';
+			p = formatFloat(p, n.x, ' ');
+			p = formatFloat(p, n.y, ' ');
+			p = formatFloat(p, n.z, '\n');
+
+			file.commit(p);
+		}
+	}
+
+	// Faces, as "f v v v" or "f v//n v//n v//n"
+	for (int f = 0; f < (int)faces.size(); ++f)
+	{
+		char* p = file.reserve();
+
+		*p++ = 'f';
+		for (int k = 0; k < 3; ++k)
+		{
+			*p++ = ' ';
+			p = formatIndex(p, remap[faces[f].idx[k]]);
+
+			if (options & HullExport::Normals)
+			{
+				*p++ = '/';
+				*p++ = '/';
+				p = formatIndex(p, f);
+			}
+		}
+		*p++ = '\n';
+
+		file.commit(p);
+	}
+
+	return file.close();
+}
+
+bool HullExport::write(const std::string& filename, const gk::Point* points, int count, const std::vector<ConvexHull3d::Face>& faces,
+	Format format, int options)
+{
+	if (format == Unknown)
+		return false;
+
+	BufferedWriter file(filename);
+	if (!file.isOpen())
+		return false;
+
+	switch (format)
+	{
+	case PLY: return writePLY(file, points, count, faces, options);
+	case STL: return writeSTL(file, points, faces, options);
+	default: return writeOBJ(file, points, count, faces, options);
+	}
+}
+
+bool HullExport::write(const std::string& filename, const gk::Point* points, int count, const std::vector<ConvexHull3d::Face>& faces,
+	int options)
+{
+	return write(filename, points, count, faces, format(filename), options);
+}
+
+HullExport::Format HullExport::format(const std::string& filename)
+{
+	size_t dot = filename.rfind('.');
+	if (dot == std::string::npos)
+		return Unknown;
+
+	std::string extension = filename.substr(dot + 1);
+	for (char& c : extension)
+		c = (char)tolower((unsigned char)c);
+
+	if (extension == "ply")
+		return PLY;
+	if (extension == "stl")
+		return STL;
+	if (extension == "obj")
+		return OBJ;
+
+	return Unknown;
+}
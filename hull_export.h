@@ -0,0 +1,43 @@
+#ifndef HULLEXPORT_H
+#define HULLEXPORT_H
+
+#include "convex_hull_3d.h"
+
+#include <string>
+#include <vector>
+
+//! Convex hull mesh exporter, writing ConvexHull3d::hull() faces as binary PLY, binary STL or OBJ.
+//! Data is formatted into a large buffer flushed in few writes, so exporting is I/O bound.
+class HullExport
+{
+public:
+
+	//! Mesh file formats.
+	enum Format
+	{
+		PLY = 0,		//! Binary little endian PLY
+		STL = 1,		//! Binary STL
+		OBJ = 2,		//! Wavefront OBJ, readable by gKit readOBJ()
+		Unknown = -1
+	};
+
+	//! Export options.
+	enum Options
+	{
+		Normals = 1 << 0,		//! Write per-face normals
+		Compact = 1 << 1		//! Only write the vertices referenced by the faces, instead of the whole point set
+	};
+
+	//! Write the specified hull faces, indexing the specified points, into a mesh file.
+	//! Returns false if the file could not be written.
+	static bool write(const std::string& filename, const gk::Point* points, int count, const std::vector<ConvexHull3d::Face>& faces,
+		Format format, int options = Compact);
+	//! Write a mesh file whose format is deduced from the file extension.
+	static bool write(const std::string& filename, const gk::Point* points, int count, const std::vector<ConvexHull3d::Face>& faces,
+		int options = Compact);
+
+	//! Get the mesh file format from the specified file extension.
+	static Format format(const std::string& filename);
+};
+
+#endif
@@ -2,13 +2,138 @@
 
 #include <numeric>
 
-void JHull2d::initialize(const gk::Vec2* points, int count)
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define JHULL_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define JHULL_SSE2
+#endif
+
+//! Independent best candidate accumulators of the vectorized scan (hides the compare and blend latency).
+#define JHULL_ACCUMULATOR_COUNT		4
+
+//! Returns true if candidate p wraps better than the current best one from p0: p on the right of (p0, best),
+//! or collinear and farther, or a duplicate with a lower index (p0 duplicates never win).
+static inline bool isBetterCandidate(float p0x, float p0y, float bestx, float besty, int bestidx, float x, float y, int idx)
+{
+	float vx = bestx - p0x;
+	float vy = besty - p0y;
+	float wx = x - p0x;
+	float wy = y - p0y;
+
+	float d = vx * wy - vy * wx;
+	if (d != 0)
+		return d < 0;
+
+	float v2 = vx * vx + vy * vy;
+	float w2 = wx * wx + wy * wy;
+
+	return w2 > v2 || (w2 == v2 && w2 > 0 && idx < bestidx);
+}
+
+#if defined(JHULL_AVX2)
+
+//! Vector lanes.
+typedef __m256 Floats;
+typedef __m256i Ints;
+
+static const int LaneCount = 8;
+
+static inline Floats set(float f) { return _mm256_set1_ps(f); }
+static inline Ints set(int i) { return _mm256_set1_epi32(i); }
+static inline Ints lanes() { return _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7); }
+static inline Floats load(const float* f) { return _mm256_loadu_ps(f); }
+static inline void store(float* f, Floats v) { _mm256_storeu_ps(f, v); }
+static inline void store(int* i, Ints v) { _mm256_storeu_si256((__m256i*)i, v); }
+static inline Floats add(Floats a, Floats b) { return _mm256_add_ps(a, b); }
+static inline Floats sub(Floats a, Floats b) { return _mm256_sub_ps(a, b); }
+static inline Floats mul(Floats a, Floats b) { return _mm256_mul_ps(a, b); }
+static inline Ints add(Ints a, Ints b) { return _mm256_add_epi32(a, b); }
+static inline Floats less(Floats a, Floats b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+static inline Floats equal(Floats a, Floats b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+static inline Floats both(Floats a, Floats b) { return _mm256_and_ps(a, b); }
+static inline Floats either(Floats a, Floats b) { return _mm256_or_ps(a, b); }
+static inline Floats select(Floats mask, Floats a, Floats b) { return _mm256_blendv_ps(b, a, mask); }
+static inline Ints select(Floats mask, Ints a, Ints b)
+{
+	return _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(b), _mm256_castsi256_ps(a), mask));
+}
+
+#elif defined(JHULL_SSE2)
+
+//! Vector lanes.
+typedef __m128 Floats;
+typedef __m128i Ints;
+
+static const int LaneCount = 4;
+
+static inline Floats set(float f) { return _mm_set1_ps(f); }
+static inline Ints set(int i) { return _mm_set1_epi32(i); }
+static inline Ints lanes() { return _mm_setr_epi32(0, 1, 2, 3); }
+static inline Floats load(const float* f) { return _mm_loadu_ps(f); }
+static inline void store(float* f, Floats v) { _mm_storeu_ps(f, v); }
+static inline void store(int* i, Ints v) { _mm_storeu_si128((__m128i*)i, v); }
+static inline Floats add(Floats a, Floats b) { return _mm_add_ps(a, b); }
+static inline Floats sub(Floats a, Floats b) { return _mm_sub_ps(a, b); }
+static inline Floats mul(Floats a, Floats b) { return _mm_mul_ps(a, b); }
+static inline Ints add(Ints a, Ints b) { return _mm_add_epi32(a, b); }
+static inline Floats less(Floats a, Floats b) { return _mm_cmplt_ps(a, b); }
+static inline Floats equal(Floats a, Floats b) { return _mm_cmpeq_ps(a, b); }
+static inline Floats both(Floats a, Floats b) { return _mm_and_ps(a, b); }
+static inline Floats either(Floats a, Floats b) { return _mm_or_ps(a, b); }
+static inline Floats select(Floats mask, Floats a, Floats b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+static inline Ints select(Floats mask, Ints a, Ints b)
+{
+	__m128i m = _mm_castps_si128(mask);
+	return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b));
+}
+
+#endif
+
+#if defined(JHULL_AVX2) || defined(JHULL_SSE2)
+
+//! Per lane best candidates.
+struct Candidates
+{
+	Floats x;
+	Floats y;
+	Ints idx;
+};
+
+//! Replace the lanes' best candidates by the better ones among the specified points (same rule as isBetterCandidate(),
+//! duplicates keeping the first seen).
+static inline void updateCandidates(Candidates& best, Floats p0x, Floats p0y, Floats x, Floats y, Ints idx)
+{
+	Floats vx = sub(best.x, p0x);
+	Floats vy = sub(best.y, p0y);
+	Floats wx = sub(x, p0x);
+	Floats wy = sub(y, p0y);
+
+	Floats d = sub(mul(vx, wy), mul(vy, wx));
+	Floats v2 = add(mul(vx, vx), mul(vy, vy));
+	Floats w2 = add(mul(wx, wx), mul(wy, wy));
+
+	Floats zero = set(0.f);
+	Floats better = either(less(d, zero), both(equal(d, zero), less(v2, w2)));
+
+	best.x = select(better, x, best.x);
+	best.y = select(better, y, best.y);
+	best.idx = select(better, idx, best.idx);
+}
+
+#endif
+
+void JHull2d::initialize(const PointView2d& points, int count)
 {
 	clear();
 
 	_points = points;
 	_pointcount = count;
 
+	_xs.resize(_pointcount);
+	_ys.resize(_pointcount);
+
 	// Find the lexicographical minimal point and insert this one into the convex hull
 	int minidx;
 	gk::Vec2 min(HUGE_VALF, HUGE_VALF);
@@ -21,7 +146,90 @@ void JHull2d::initialize(const gk::Vec2* points, int count)
 			min = p;
 			minidx = i;
 		}
+
+		_xs[i] = p.x;
+		_ys[i] = p.y;
 	}
 
 	_hullpointsidx.push_back(minidx);
-}
\ No newline at end of file
+}
+
+int JHull2d::getNextVertex(int p0idx) const
+{
+	const float* xs = _xs.data();
+	const float* ys = _ys.data();
+
+	float p0x = xs[p0idx];
+	float p0y = ys[p0idx];
+
+	// Best candidate, starting from p0 itself which any other point beats
+	float bestx = p0x;
+	float besty = p0y;
+	int bestidx = -1;
+
+	int i = 0;
+
+#if defined(JHULL_AVX2) || defined(JHULL_SSE2)
+	// Vectorized scan: each accumulator lane keeps its own best candidate, all of them being reduced afterwards
+	const int blocksize = JHULL_ACCUMULATOR_COUNT * LaneCount;
+
+	Floats p0xs = set(p0x);
+	Floats p0ys = set(p0y);
+
+	Candidates candidates[JHULL_ACCUMULATOR_COUNT];
+	for (Candidates& c : candidates)
+	{
+		c.x = p0xs;
+		c.y = p0ys;
+		c.idx = set(-1);
+	}
+
+	Ints idxs = lanes();
+	Ints step = set(LaneCount);
+
+	for (; i + blocksize <= _pointcount; i += blocksize)
+	{
+		for (int a = 0; a < JHULL_ACCUMULATOR_COUNT; ++a)
+		{
+			int first = i + a * LaneCount;
+
+			updateCandidates(candidates[a], p0xs, p0ys, load(xs + first), load(ys + first), idxs);
+			idxs = add(idxs, step);
+		}
+	}
+
+	for (int a = 0; a < JHULL_ACCUMULATOR_COUNT; ++a)
+	{
+		float lanexs[LaneCount];
+		float laneys[LaneCount];
+		int laneidxs[LaneCount];
+
+		store(lanexs, candidates[a].x);
+		store(laneys, candidates[a].y);
+		store(laneidxs, candidates[a].idx);
+
+		for (int lane = 0; lane < LaneCount; ++lane)
+		{
+			if (laneidxs[lane] >= 0 && isBetterCandidate(p0x, p0y, bestx, besty, bestidx, lanexs[lane], laneys[lane], laneidxs[lane]))
+			{
+				bestx = lanexs[lane];
+				besty = laneys[lane];
+				bestidx = laneidxs[lane];
+			}
+		}
+	}
+#endif
+
+	// Remaining points
+	for (; i < _pointcount; ++i)
+	{
+		if (isBetterCandidate(p0x, p0y, bestx, besty, bestidx, xs[i], ys[i], i))
+		{
+			bestx = xs[i];
+			besty = ys[i];
+			bestidx = i;
+		}
+	}
+
+	return bestidx;
+}
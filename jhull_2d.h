@@ -16,12 +16,19 @@ private:
 	int _iterationid;
 
 	//! Input points.
-	const gk::Vec2* _points;
+	PointView2d _points;
 	int _pointcount;
+	//! Input points' coordinates, as separate arrays for the vectorized wrapping scan.
+	std::vector<float> _xs;
+	std::vector<float> _ys;
 
 	//! Convex hull's point indices.
 	std::vector<int> _hullpointsidx;
 
+	//! Get the point wrapping the hull from the specified vertex: no point lies on the right of (p0, p1),
+	//! the farthest one (then the first one) being chosen among collinear points. Returns -1 if all the points are p0.
+	int getNextVertex(int p0idx) const;
+
 public:
 
 	JHull2d() { clear(); }
@@ -31,7 +38,8 @@ public:
 
 	virtual void clear();
 
-	virtual void initialize(const gk::Vec2* points, int count);
+	using ConvexHull2d::initialize;
+	virtual void initialize(const PointView2d& points, int count);
 
 	virtual int build();
 	virtual bool iterate();
@@ -48,6 +56,8 @@ inline JHull2d& JHull2d::operator=(JHull2d&& hull)
 
 		_points = std::move(hull._points);
 		_pointcount = hull._pointcount;
+		_xs = std::move(hull._xs);
+		_ys = std::move(hull._ys);
 
 		_hullpointsidx = std::move(hull._hullpointsidx);
 	}
@@ -59,8 +69,10 @@ inline void JHull2d::clear()
 {
 	_hullpointsidx.clear();
 
-	_points = nullptr;
+	_points = PointView2d();
 	_pointcount = 0;
+	_xs.clear();
+	_ys.clear();
 
 	_iterationid = -1;
 	_done = false;
@@ -74,61 +86,14 @@ inline int JHull2d::build()
 }
 inline bool JHull2d::iterate()
 {
-	int p0idx;
-	gk::Vec2 p0;
-
-	int p1idx;
-	gk::Vec2 p1;
-	gk::Vec2 n01;
-
-	gk::Vec2 p2;
-
-	float d;
-
 	if (_done)
 		return false;
 
 	++_iterationid;
 
-	p0idx = _hullpointsidx.back();
-	p0 = _points[p0idx];
-
-	for (p1idx = 0; p1idx < (int)_pointcount; ++p1idx)
-		if (p1idx != p0idx)
-			break;
-	p1 = _points[p1idx];
-
-	n01 = gk::Vec2(p0.y - p1.y, p1.x - p0.x);
-
-	for (int i = 0; i < (int)_pointcount; ++i)
-	{
-		if (i == p0idx || i == p1idx)
-			continue;
-
-		p2 = _points[i];
-
-		d = n01.x * (p2.x - p0.x) + n01.y * (p2.y - p0.y);
-
-		if (d == 0)
-		{
-			gk::Vec2 v01(p1.x - p0.x, p1.y - p0.y);
-			gk::Vec2 v02(p2.x - p0.x, p2.y - p0.y);
-
-			if ((v02.x * v02.x + v02.y * v02.y) > (v01.x * v01.x + v01.y * v01.y))
-			{
-				p1idx = i;
-				p1 = p2;
-			}
-		}
-		else if (d < 0)
-		{
-			p1idx = i;
-			p1 = p2;
-			n01 = gk::Vec2(p0.y - p1.y, p1.x - p0.x);
-		}
-	}
+	int p1idx = getNextVertex(_hullpointsidx.back());
 
-	if (p1idx == _hullpointsidx.front())
+	if (p1idx < 0 || p1idx == _hullpointsidx.front())
 		_done = true;
 	else
 		_hullpointsidx.push_back(p1idx);
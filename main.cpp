@@ -1,4 +1,5 @@
 #include "gl_viewer.h"
+#include "qhull_trace.h"
 
 #include <cstdlib>
 #include <cstring>
@@ -11,6 +12,21 @@ int main(int argc, char** argv)
 {
 	srand(time(0));
 
+	// Options: -r restores the previous session's points, -trace <file> records a timeline
+	bool restoreprevioussession = false;
+	const char* tracefilename = nullptr;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!strcmp(argv[i], "-r"))
+			restoreprevioussession = true;
+		else if (!strcmp(argv[i], "-trace") && i + 1 < argc)
+			tracefilename = argv[++i];
+	}
+
+	if (tracefilename)
+		QHullTrace::start();
+
 	GLViewer app(
 		GLCamera(
 		Point(-50000, 10000, 0),
@@ -22,8 +38,11 @@ int main(int argc, char** argv)
 		),
 		WINDOW_WIDTH,
 		WINDOW_HEIGHT,
-		argc > 1 && !strcmp(argv[1], "-r"));
+		restoreprevioussession);
 	app.run();
 
+	if (tracefilename)
+		QHullTrace::stop(tracefilename);
+
 	return 0;
 }
\ No newline at end of file
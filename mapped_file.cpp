@@ -0,0 +1,144 @@
+#include "mapped_file.h"
+
+#include <utility>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef WIN32
+
+MappedFile::MappedFile()
+	: _data(nullptr), _size(0), _file(INVALID_HANDLE_VALUE), _mapping(nullptr)
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& file)
+{
+	if (this != &file)
+	{
+		close();
+
+		std::swap(_data, file._data);
+		std::swap(_size, file._size);
+		std::swap(_file, file._file);
+		std::swap(_mapping, file._mapping);
+	}
+
+	return *this;
+}
+
+bool MappedFile::open(const std::string& filename)
+{
+	close();
+
+	_file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (_file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(_file, &size) || size.QuadPart == 0)
+	{
+		close();
+		return false;
+	}
+
+	_mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!_mapping)
+	{
+		close();
+		return false;
+	}
+
+	_data = (const char*)MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!_data)
+	{
+		close();
+		return false;
+	}
+
+	_size = (size_t)size.QuadPart;
+
+	return true;
+}
+void MappedFile::close()
+{
+	if (_data)
+		UnmapViewOfFile(_data);
+	if (_mapping)
+		CloseHandle(_mapping);
+	if (_file != INVALID_HANDLE_VALUE)
+		CloseHandle(_file);
+
+	_data = nullptr;
+	_size = 0;
+	_file = INVALID_HANDLE_VALUE;
+	_mapping = nullptr;
+}
+
+#else
+
+MappedFile::MappedFile()
+	: _data(nullptr), _size(0), _file(-1)
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& file)
+{
+	if (this != &file)
+	{
+		close();
+
+		std::swap(_data, file._data);
+		std::swap(_size, file._size);
+		std::swap(_file, file._file);
+	}
+
+	return *this;
+}
+
+bool MappedFile::open(const std::string& filename)
+{
+	close();
+
+	_file = ::open(filename.c_str(), O_RDONLY);
+	if (_file < 0)
+		return false;
+
+	struct stat infos;
+	if (fstat(_file, &infos) < 0 || infos.st_size == 0)
+	{
+		close();
+		return false;
+	}
+
+	void* data = mmap(nullptr, (size_t)infos.st_size, PROT_READ, MAP_SHARED, _file, 0);
+	if (data == MAP_FAILED)
+	{
+		close();
+		return false;
+	}
+
+	_data = (const char*)data;
+	_size = (size_t)infos.st_size;
+
+	return true;
+}
+void MappedFile::close()
+{
+	if (_data)
+		munmap((void*)_data, _size);
+	if (_file >= 0)
+		::close(_file);
+
+	_data = nullptr;
+	_size = 0;
+	_file = -1;
+}
+
+#endif
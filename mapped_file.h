@@ -0,0 +1,50 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <string>
+#include <cstddef>
+
+//! Read-only memory mapped file.
+//! Opening a file only reserves its address range: pages are loaded on demand when accessed.
+class MappedFile
+{
+private:
+
+	//! Mapped data.
+	const char* _data;
+	//! Mapped size in bytes.
+	size_t _size;
+
+#ifdef WIN32
+	void* _file;		//! File handle
+	void* _mapping;		//! File mapping handle
+#else
+	int _file;			//! File descriptor
+#endif
+
+public:
+
+	MappedFile();
+	MappedFile(MappedFile&& file) : MappedFile() { *this = std::move(file); }
+	~MappedFile() { close(); }
+
+	MappedFile& operator=(MappedFile&& file);
+
+	//! Map the specified file.
+	//! Returns false if the file could not be mapped.
+	bool open(const std::string& filename);
+	//! Unmap the current file.
+	void close();
+
+	bool isOpen() const { return _data != nullptr; }
+
+	const char* data() const { return _data; }
+	size_t size() const { return _size; }
+
+private:
+
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+};
+
+#endif
@@ -0,0 +1,31 @@
+#include "mhull_2d.h"
+
+#include <numeric>
+
+void MHull2d::initialize(const PointView2d& points, int count)
+{
+	clear();
+
+	_points = points;
+	_pointcount = count;
+
+	if (_pointcount == 0)
+	{
+		_done = true;
+		return;
+	}
+
+	// Sort the points lexicographically, the minimal one being the hull's first vertex
+	_sortedidx.resize(_pointcount);
+	std::iota(_sortedidx.begin(), _sortedidx.end(), 0);
+
+	std::sort(_sortedidx.begin(), _sortedidx.end(), [points](int i1, int i2)
+	{
+		return points[i1].x < points[i2].x || (points[i1].x == points[i2].x && points[i1].y < points[i2].y);
+	});
+
+	_hullpointsidx.push_back(_sortedidx[0]);
+
+	if (_pointcount == 1)
+		_done = true;
+}
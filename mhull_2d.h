@@ -0,0 +1,150 @@
+#ifndef MHULL2D_H
+#define MHULL2D_H
+
+#include "convex_hull_2d.h"
+
+#include <algorithm>
+
+//! Monotone chain (Andrew's algorithm) 2D implementation for convex hull (O(n log n) complexity, whatever the hull size).
+//! Points are sorted at initialization, then each iteration inserts one point into the lower, then upper, chain.
+class MHull2d : public ConvexHull2d
+{
+private:
+
+	//! End flag.
+	bool _done;
+	//! Iteration identifier.
+	int _iterationid;
+
+	//! Input points.
+	PointView2d _points;
+	int _pointcount;
+
+	//! Point indices in lexicographical order.
+	std::vector<int> _sortedidx;
+	//! Lower chain's point count, once complete (0 while building it).
+	int _lowercount;
+
+	//! Convex hull's point indices (lower chain followed by upper chain).
+	std::vector<int> _hullpointsidx;
+
+	//! Returns true if p2 lies strictly on the left of the oriented line (p0, p1).
+	bool isLeftTurn(int p0idx, int p1idx, int p2idx) const
+	{
+		gk::Vec2 p0 = _points[p0idx];
+		gk::Vec2 p1 = _points[p1idx];
+		gk::Vec2 p2 = _points[p2idx];
+
+		return (p1.x - p0.x) * (p2.y - p0.y) - (p1.y - p0.y) * (p2.x - p0.x) > 0;
+	}
+
+public:
+
+	MHull2d() { clear(); }
+	MHull2d(MHull2d&& hull) { *this = std::move(hull); }
+
+	MHull2d& operator=(MHull2d&& hull);
+
+	virtual void clear();
+
+	using ConvexHull2d::initialize;
+	virtual void initialize(const PointView2d& points, int count);
+
+	virtual int build();
+	virtual bool iterate();
+
+	virtual std::vector<int> hull() const { return _hullpointsidx; }
+};
+
+inline MHull2d& MHull2d::operator=(MHull2d&& hull)
+{
+	if (this != &hull)
+	{
+		_done = hull._done;
+		_iterationid = hull._iterationid;
+
+		_points = std::move(hull._points);
+		_pointcount = hull._pointcount;
+
+		_sortedidx = std::move(hull._sortedidx);
+		_lowercount = hull._lowercount;
+
+		_hullpointsidx = std::move(hull._hullpointsidx);
+	}
+
+	return *this;
+}
+
+inline void MHull2d::clear()
+{
+	_hullpointsidx.clear();
+
+	_sortedidx.clear();
+	_lowercount = 0;
+
+	_points = PointView2d();
+	_pointcount = 0;
+
+	_iterationid = -1;
+	_done = false;
+}
+
+inline int MHull2d::build()
+{
+	while (iterate());
+
+	return _iterationid + 1;
+}
+inline bool MHull2d::iterate()
+{
+	int pidx;
+	bool closing;
+
+	if (_done)
+		return false;
+
+	++_iterationid;
+
+	// Sorted point to insert (the first one has been inserted at initialization): forward for the lower chain,
+	// then backward for the upper chain, down to the first point which closes the hull
+	int step = _iterationid + 1;
+
+	if (step < _pointcount)
+	{
+		pidx = _sortedidx[step];
+		closing = false;
+	}
+	else
+	{
+		if (_lowercount == 0)
+			_lowercount = (int)_hullpointsidx.size();
+
+		pidx = _sortedidx[2 * _pointcount - 2 - step];
+		closing = (step == 2 * _pointcount - 2);
+	}
+
+	// Pop the vertices making a right turn or a collinear triple (the upper chain cannot pop into the lower one)
+	int mincount = (_lowercount > 0) ? _lowercount + 1 : 2;
+
+	while ((int)_hullpointsidx.size() >= mincount
+		&& !isLeftTurn(_hullpointsidx[_hullpointsidx.size() - 2], _hullpointsidx.back(), pidx))
+		_hullpointsidx.pop_back();
+
+	if (closing)
+	{
+		_done = true;
+	}
+	else
+	{
+		// Skip duplicates of the last vertex
+		gk::Vec2 p = _points[pidx];
+		gk::Vec2 last = _points[_hullpointsidx.back()];
+
+		if (p.x != last.x || p.y != last.y)
+			_hullpointsidx.push_back(pidx);
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+//! Get the effective thread count for the specified requested count (0: all cores).
+inline int threadCount(int requested = 0)
+{
+	if (requested > 0)
+		return requested;
+
+	return std::max(1, (int)std::thread::hardware_concurrency());
+}
+
+//! Run the specified task over [0, count) split into contiguous ranges, one per thread.
+//! The task is called as task(thread, begin, end), the calling thread running the first range.
+template <typename Task>
+void parallelFor(long long count, int threadcount, const Task& task)
+{
+	threadcount = (int)std::max(1LL, std::min((long long)threadCount(threadcount), count));
+
+	std::vector<std::thread> threads;
+	threads.reserve(threadcount - 1);
+
+	for (int t = 1; t < threadcount; ++t)
+		threads.push_back(std::thread([&task, t, count, threadcount]()
+		{
+			task(t, (count * t) / threadcount, (count * (t + 1)) / threadcount);
+		}));
+
+	task(0, 0LL, count / threadcount);
+
+	for (int t = 0; t < (int)threads.size(); ++t)
+		threads[t].join();
+}
+
+#endif
@@ -0,0 +1,210 @@
+#include "point_dedup.h"
+#include "parallel.h"
+#include "qhull_trace.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define POINT_DEDUP_SSE2
+#endif
+
+#define POINT_DEDUP_MIN_CHUNK	(1 << 16)
+#define POINT_DEDUP_PREFETCH	16
+#define POINT_DEDUP_MAX_CELL	(double)(1LL << 62)
+#define POINT_DEDUP_EMPTY		(~0ULL)
+#define POINT_DEDUP_TAG_MASK	(~0ULL << 32)
+
+//! Grid cell, or bitwise coordinates for exact elimination.
+struct DedupCell
+{
+	long long x, y, z;
+
+	bool operator==(const DedupCell& cell) const { return x == cell.x && y == cell.y && z == cell.z; }
+};
+
+static inline long long quantize(float v, double scale)
+{
+	if (scale == 0)
+	{
+		// Bitwise, -0 and +0 being merged
+		uint32_t bits;
+		v = (v == 0.f) ? 0.f : v;
+		memcpy(&bits, &v, sizeof(bits));
+
+		return bits;
+	}
+
+	// Floor by truncation, libm's floor() being a call without SSE4.1
+	double c = std::max(-POINT_DEDUP_MAX_CELL, std::min(POINT_DEDUP_MAX_CELL, v * scale));
+	long long cell = (long long)c;
+
+	return cell - (c < (double)cell);
+}
+static inline DedupCell getCell(const gk::Point& p, double scale)
+{
+	DedupCell cell = { quantize(p.x, scale), quantize(p.y, scale), quantize(p.z, scale) };
+
+	return cell;
+}
+static inline uint64_t hashCell(const DedupCell& cell)
+{
+	uint64_t h = (uint64_t)cell.x * 0x9e3779b97f4a7c15ULL;
+	h = (h ^ (h >> 29) ^ (uint64_t)cell.y) * 0xbf58476d1ce4e5b9ULL;
+	h = (h ^ (h >> 32) ^ (uint64_t)cell.z) * 0x94d049bb133111ebULL;
+
+	return h ^ (h >> 31);
+}
+static inline void prefetch(const void* p)
+{
+#ifdef POINT_DEDUP_SSE2
+	_mm_prefetch((const char*)p, _MM_HINT_T0);
+#else
+	(void)p;
+#endif
+}
+
+int PointDedup::run(const gk::Point* points, int count)
+{
+	QHULL_TRACE("PointDedup::run");
+
+	clear();
+
+	if (count <= 0)
+		return 0;
+
+	double scale = (_quantum > 0) ? 1.0 / _quantum : 0.0;
+
+	// Table of at least twice the point count, slots holding a hash tag and the smallest index of their cell's points
+	size_t tablesize = 1;
+	while (tablesize < 2 * (size_t)count)
+		tablesize <<= 1;
+
+	size_t mask = tablesize - 1;
+	std::unique_ptr<std::atomic<uint64_t>[]> table(new std::atomic<uint64_t>[tablesize]);
+
+	int chunkcount = (int)std::min<long long>(threadCount(_threadcount), count / POINT_DEDUP_MIN_CHUNK + 1);
+
+	parallelFor((long long)tablesize, chunkcount, [&](int, long long first, long long last)
+	{
+		for (long long s = first; s < last; ++s)
+			table[s].store(POINT_DEDUP_EMPTY, std::memory_order_relaxed);
+	});
+
+	// Insert the points, each one's home slot being prefetched a few points ahead, then resolve each point's first occurrence
+	std::vector<int> firsts(count);
+
+	parallelFor(count, chunkcount, [&](int, long long first, long long last)
+	{
+		DedupCell cells[POINT_DEDUP_PREFETCH];
+		uint64_t hashes[POINT_DEDUP_PREFETCH];
+
+		for (int i = (int)first; i < (int)last + POINT_DEDUP_PREFETCH; ++i)
+		{
+			int ahead = i % POINT_DEDUP_PREFETCH;
+
+			// Insert the point fetched POINT_DEDUP_PREFETCH points ago, then fetch the current one in its place
+			int p = i - POINT_DEDUP_PREFETCH;
+			if (p >= (int)first)
+			{
+				uint64_t entry = (hashes[ahead] & POINT_DEDUP_TAG_MASK) | (uint32_t)p;
+				size_t s = hashes[ahead] & mask;
+
+				for (;;)
+				{
+					uint64_t e = table[s].load(std::memory_order_relaxed);
+
+					if (e == POINT_DEDUP_EMPTY)
+					{
+						if (table[s].compare_exchange_weak(e, entry, std::memory_order_relaxed))
+							break;
+
+						continue;
+					}
+
+					if ((e & POINT_DEDUP_TAG_MASK) == (entry & POINT_DEDUP_TAG_MASK) && getCell(points[(uint32_t)e], scale) == cells[ahead])
+					{
+						while ((int)(uint32_t)e > p && !table[s].compare_exchange_weak(e, entry, std::memory_order_relaxed)) {}
+						break;
+					}
+
+					s = (s + 1) & mask;
+				}
+
+				firsts[p] = (int)s;
+			}
+
+			if (i < (int)last)
+			{
+				cells[ahead] = getCell(points[i], scale);
+				hashes[ahead] = hashCell(cells[ahead]);
+				prefetch(&table[hashes[ahead] & mask]);
+			}
+		}
+	});
+
+	parallelFor(count, chunkcount, [&](int, long long first, long long last)
+	{
+		for (long long i = first; i < last; ++i)
+			firsts[i] = (int)(uint32_t)table[firsts[i]].load(std::memory_order_relaxed);
+	});
+
+	table.reset();
+
+	// Count each chunk's unique points (their own first occurrence), then compact them in order
+	std::vector<int> offsets(chunkcount + 1, 0);
+
+	parallelFor(chunkcount, chunkcount, [&](int, long long first, long long last)
+	{
+		for (long long c = first; c < last; ++c)
+		{
+			int begin = (int)(((long long)count * c) / chunkcount);
+			int end = (int)(((long long)count * (c + 1)) / chunkcount);
+
+			for (int i = begin; i < end; ++i)
+				offsets[c + 1] += (firsts[i] == i);
+		}
+	});
+
+	for (int c = 0; c < chunkcount; ++c)
+		offsets[c + 1] += offsets[c];
+
+	_points.resize(offsets[chunkcount]);
+	_originalindices.resize(offsets[chunkcount]);
+	_uniqueindices.resize(count);
+
+	parallelFor(chunkcount, chunkcount, [&](int, long long first, long long last)
+	{
+		for (long long c = first; c < last; ++c)
+		{
+			int begin = (int)(((long long)count * c) / chunkcount);
+			int end = (int)(((long long)count * (c + 1)) / chunkcount);
+			int k = offsets[c];
+
+			for (int i = begin; i < end; ++i)
+			{
+				if (firsts[i] == i)
+				{
+					_points[k] = points[i];
+					_originalindices[k] = i;
+					_uniqueindices[i] = k++;
+				}
+			}
+		}
+	});
+
+	// Point the duplicates to their first occurrence's unique point
+	parallelFor(count, chunkcount, [&](int, long long first, long long last)
+	{
+		for (long long i = first; i < last; ++i)
+		{
+			if (firsts[i] != i)
+				_uniqueindices[i] = _uniqueindices[firsts[i]];
+		}
+	});
+
+	return (int)_points.size();
+}
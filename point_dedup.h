@@ -0,0 +1,74 @@
+#ifndef POINTDEDUP_H
+#define POINTDEDUP_H
+
+#include "convex_hull_3d.h"
+
+#include <vector>
+
+//! Duplicate point elimination pre-pass, using a parallel open addressing hash table.
+//! Points are merged when their coordinates are bitwise equal, or when they fall into the same cell of a grid of the specified quantum.
+//! The unique points are kept in first occurrence order, each one keeping its first occurrence's exact coordinates.
+class PointDedup
+{
+private:
+
+	//! Grid cell size (0: exact duplicates only).
+	float _quantum;
+	//! Thread count (0: all cores).
+	int _threadcount;
+
+	//! Unique points.
+	std::vector<gk::Point> _points;
+	//! Original index of each unique point.
+	std::vector<int> _originalindices;
+	//! Unique index of each original point.
+	std::vector<int> _uniqueindices;
+
+public:
+
+	PointDedup(float quantum = 0.f, int threadcount = 0) : _quantum(quantum), _threadcount(threadcount) {}
+
+	//! Clear internal data.
+	void clear();
+
+	//! Eliminate the duplicates of the specified points.
+	//! Returns the unique point count.
+	int run(const gk::Point* points, int count);
+
+	//! Get the unique point count.
+	int count() const { return (int)_points.size(); }
+	//! Get the unique points, to be hulled in place of the original ones.
+	const gk::Point* points() const { return _points.empty() ? nullptr : &_points[0]; }
+
+	//! Get the original index of each unique point.
+	const std::vector<int>& originalIndices() const { return _originalindices; }
+	//! Get the unique index of each original point.
+	const std::vector<int>& uniqueIndices() const { return _uniqueindices; }
+
+	//! Remap the specified faces, indexed into the unique points, to the original indices.
+	void remap(std::vector<ConvexHull3d::Face>& faces) const;
+	//! Remap the specified unique point indices to the original indices.
+	void remap(std::vector<int>& indices) const;
+};
+
+inline void PointDedup::clear()
+{
+	_points.clear();
+	_originalindices.clear();
+	_uniqueindices.clear();
+}
+
+inline void PointDedup::remap(std::vector<ConvexHull3d::Face>& faces) const
+{
+	for (ConvexHull3d::Face& face : faces)
+		for (int k = 0; k < 3; ++k)
+			face.idx[k] = _originalindices[face.idx[k]];
+}
+
+inline void PointDedup::remap(std::vector<int>& indices) const
+{
+	for (int& index : indices)
+		index = _originalindices[index];
+}
+
+#endif
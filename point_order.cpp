@@ -0,0 +1,174 @@
+#include "point_order.h"
+#include "parallel.h"
+#include "qhull_trace.h"
+
+#include <cstdint>
+
+#define POINT_ORDER_MIN_CHUNK	(1 << 16)
+#define POINT_ORDER_BITS		10
+#define POINT_ORDER_RADIX_BITS	10
+#define POINT_ORDER_RADIX		(1 << POINT_ORDER_RADIX_BITS)
+
+//! Spread the specified 10 bit coordinate's bits two bits apart.
+static inline uint32_t spreadBits(uint32_t v)
+{
+	v = (v | (v << 16)) & 0x030000ff;
+	v = (v | (v << 8)) & 0x0300f00f;
+	v = (v | (v << 4)) & 0x030c30c3;
+	v = (v | (v << 2)) & 0x09249249;
+
+	return v;
+}
+static inline uint32_t mortonKey(uint32_t x, uint32_t y, uint32_t z)
+{
+	return (spreadBits(x) << 2) | (spreadBits(y) << 1) | spreadBits(z);
+}
+//! Hilbert key, from Skilling's transposed Hilbert index ("Programming the Hilbert curve", 2004).
+static inline uint32_t hilbertKey(uint32_t x, uint32_t y, uint32_t z)
+{
+	// Inverse undo: for each axis, invert x's low bits if the axis' bit q is set, exchange them with the axis' otherwise
+	// (branchless, the bits being random)
+	for (uint32_t q = 1 << (POINT_ORDER_BITS - 1); q > 1; q >>= 1)
+	{
+		uint32_t p = q - 1;
+		uint32_t set, t;
+
+		x ^= p & (0u - ((x & q) != 0));
+
+		set = 0u - ((y & q) != 0);
+		x ^= p & set;
+		t = (x ^ y) & p & ~set;
+		x ^= t;
+		y ^= t;
+
+		set = 0u - ((z & q) != 0);
+		x ^= p & set;
+		t = (x ^ z) & p & ~set;
+		x ^= t;
+		z ^= t;
+	}
+
+	// Gray encode
+	y ^= x;
+	z ^= y;
+
+	uint32_t t = 0;
+	for (uint32_t q = 1 << (POINT_ORDER_BITS - 1); q > 1; q >>= 1)
+		t ^= (q - 1) & (0u - ((z & q) != 0));
+
+	return mortonKey(x ^ t, y ^ t, z ^ t);
+}
+
+void PointOrder::run(const gk::Point* points, int count)
+{
+	QHULL_TRACE("PointOrder::run");
+
+	clear();
+
+	if (count <= 0)
+		return;
+
+	int chunkcount = (int)std::min<long long>(threadCount(_threadcount), count / POINT_ORDER_MIN_CHUNK + 1);
+
+	// Bounding box
+	std::vector<gk::BBox> boxes(chunkcount);
+
+	parallelFor(count, chunkcount, [&](int chunk, long long first, long long last)
+	{
+		for (long long i = first; i < last; ++i)
+			boxes[chunk].Union(points[i]);
+	});
+
+	gk::BBox box = boxes[0];
+	for (int c = 1; c < chunkcount; ++c)
+		box.Union(boxes[c]);
+
+	// Keys of the points' cells, paired with their indices
+	const float cells = (float)((1 << POINT_ORDER_BITS) - 1);
+	gk::Vector extent(box.pMin, box.pMax);
+	gk::Vector scale(
+		(extent.x > 0) ? cells / extent.x : 0.f,
+		(extent.y > 0) ? cells / extent.y : 0.f,
+		(extent.z > 0) ? cells / extent.z : 0.f);
+
+	std::vector<uint64_t> pairs(count);
+	std::vector<uint64_t> sorted(count);
+
+	parallelFor(count, chunkcount, [&](int, long long first, long long last)
+	{
+		for (long long i = first; i < last; ++i)
+		{
+			uint32_t x = (uint32_t)std::min(cells, (points[i].x - box.pMin.x) * scale.x);
+			uint32_t y = (uint32_t)std::min(cells, (points[i].y - box.pMin.y) * scale.y);
+			uint32_t z = (uint32_t)std::min(cells, (points[i].z - box.pMin.z) * scale.z);
+
+			uint32_t key = (_curve == Hilbert) ? hilbertKey(x, y, z) : mortonKey(x, y, z);
+
+			pairs[i] = ((uint64_t)key << 32) | (uint32_t)i;
+		}
+	});
+
+	// Stable LSD radix sort on the keys, each pass scattering every chunk's points behind the previous chunks' ones
+	std::vector<int> histograms((size_t)chunkcount * POINT_ORDER_RADIX);
+
+	for (int shift = 32; shift < 32 + 3 * POINT_ORDER_BITS; shift += POINT_ORDER_RADIX_BITS)
+	{
+		std::fill(histograms.begin(), histograms.end(), 0);
+
+		parallelFor(chunkcount, chunkcount, [&](int, long long firstchunk, long long lastchunk)
+		{
+			for (long long c = firstchunk; c < lastchunk; ++c)
+			{
+				int* histogram = &histograms[c * POINT_ORDER_RADIX];
+				long long first = ((long long)count * c) / chunkcount;
+				long long last = ((long long)count * (c + 1)) / chunkcount;
+
+				for (long long i = first; i < last; ++i)
+					++histogram[(pairs[i] >> shift) & (POINT_ORDER_RADIX - 1)];
+			}
+		});
+
+		int offset = 0;
+		for (int digit = 0; digit < POINT_ORDER_RADIX; ++digit)
+		{
+			for (int c = 0; c < chunkcount; ++c)
+			{
+				int n = histograms[c * POINT_ORDER_RADIX + digit];
+				histograms[c * POINT_ORDER_RADIX + digit] = offset;
+				offset += n;
+			}
+		}
+
+		parallelFor(chunkcount, chunkcount, [&](int, long long firstchunk, long long lastchunk)
+		{
+			for (long long c = firstchunk; c < lastchunk; ++c)
+			{
+				int* offsets = &histograms[c * POINT_ORDER_RADIX];
+				long long first = ((long long)count * c) / chunkcount;
+				long long last = ((long long)count * (c + 1)) / chunkcount;
+
+				for (long long i = first; i < last; ++i)
+					sorted[offsets[(pairs[i] >> shift) & (POINT_ORDER_RADIX - 1)]++] = pairs[i];
+			}
+		});
+
+		pairs.swap(sorted);
+	}
+
+	sorted = std::vector<uint64_t>();
+
+	// Gather the points
+	_points.resize(count);
+	_originalindices.resize(count);
+
+	parallelFor(count, chunkcount, [&](int, long long first, long long last)
+	{
+		for (long long i = first; i < last; ++i)
+		{
+			int idx = (int)(uint32_t)pairs[i];
+
+			_points[i] = points[idx];
+			_originalindices[i] = idx;
+		}
+	});
+}
@@ -0,0 +1,75 @@
+#ifndef POINTORDER_H
+#define POINTORDER_H
+
+#include "convex_hull_3d.h"
+
+#include <vector>
+
+//! Space filling curve reordering pre-pass: the points are sorted along a Morton or Hilbert curve over their bounding box,
+//! so that points close in space are close in memory when the hull walks its conflict lists and distance loops.
+class PointOrder
+{
+public:
+
+	//! Space filling curves.
+	enum Curve
+	{
+		Morton,		//! Z-order: cheapest keys
+		Hilbert		//! Hilbert curve: no long jumps between consecutive cells
+	};
+
+private:
+
+	Curve _curve;
+	//! Thread count (0: all cores).
+	int _threadcount;
+
+	//! Reordered points.
+	std::vector<gk::Point> _points;
+	//! Original index of each reordered point.
+	std::vector<int> _originalindices;
+
+public:
+
+	PointOrder(Curve curve = Hilbert, int threadcount = 0) : _curve(curve), _threadcount(threadcount) {}
+
+	//! Clear internal data.
+	void clear();
+
+	//! Reorder the specified points.
+	void run(const gk::Point* points, int count);
+
+	//! Get the reordered point count.
+	int count() const { return (int)_points.size(); }
+	//! Get the reordered points, to be hulled in place of the original ones.
+	const gk::Point* points() const { return _points.empty() ? nullptr : &_points[0]; }
+
+	//! Get the original index of each reordered point.
+	const std::vector<int>& originalIndices() const { return _originalindices; }
+
+	//! Remap the specified faces, indexed into the reordered points, to the original indices.
+	void remap(std::vector<ConvexHull3d::Face>& faces) const;
+	//! Remap the specified reordered point indices to the original indices.
+	void remap(std::vector<int>& indices) const;
+};
+
+inline void PointOrder::clear()
+{
+	_points.clear();
+	_originalindices.clear();
+}
+
+inline void PointOrder::remap(std::vector<ConvexHull3d::Face>& faces) const
+{
+	for (ConvexHull3d::Face& face : faces)
+		for (int k = 0; k < 3; ++k)
+			face.idx[k] = _originalindices[face.idx[k]];
+}
+
+inline void PointOrder::remap(std::vector<int>& indices) const
+{
+	for (int& index : indices)
+		index = _originalindices[index];
+}
+
+#endif
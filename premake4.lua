@@ -4,6 +4,16 @@ function postBuildCommandsWin32()
 	postbuildcommands { "copy /Y local\\windows\\lib\\*.dll " .. binDirectory }
 end
 
+newoption {
+	trigger = "stats",
+	description = "Accumulate QHull3d build statistics (QHULL_STATS)"
+}
+
+newoption {
+	trigger = "avx2",
+	description = "Enable AVX2 code paths (8 wide JHull2d wrapping scan, SSE2 otherwise)"
+}
+
 solution "qhull"
 
 	configurations { "Debug", "Release" }
@@ -31,6 +41,27 @@ solution "qhull"
 		end
 	end
 
+	-- C++17 (std::from_chars, std::to_chars) and threads
+	configuration {}
+	if _ACTION == "gmake" then
+		buildoptions { "-std=c++17" }
+		links { "pthread" }
+	elseif string.find(_ACTION or "", "vs") then
+		buildoptions { "/std:c++17" }
+	end
+
+	if _OPTIONS["stats"] then
+		defines { "QHULL_STATS" }
+	end
+
+	if _OPTIONS["avx2"] then
+		if _ACTION == "gmake" then
+			buildoptions { "-mavx2" }
+		elseif string.find(_ACTION or "", "vs") then
+			buildoptions { "/arch:AVX2" }
+		end
+	end
+
 	-- Configuration specific definitions
 	configuration "Debug"
 		defines { "_DEBUG" }
@@ -53,21 +84,77 @@ solution "qhull"
 
 	configuration {} -- Back to all configurations
 
-	-- Project
+	-- Library: GL-free hull algorithms and point/mesh file I/O
+	project "qhullcore"
+
+	kind "StaticLib"
+	files {
+		"convex_hull_2d.h", "convex_hull_3d.h",
+		"jhull_2d.h", "jhull_2d.cpp",
+		"mhull_2d.h", "mhull_2d.cpp",
+		"chanhull_2d.h", "chanhull_2d.cpp",
+		"qhull_3d.h", "qhull_3d.cpp", "qhull_stats.h",
+		"small_hull_3d.h",
+		"qhull_trace.h", "qhull_trace.cpp",
+		"qhull_stream.h", "qhull_stream.cpp",
+		"point_dedup.h", "point_dedup.cpp",
+		"point_order.h", "point_order.cpp",
+		"compact_hull.h", "compact_hull.cpp",
+		"parallel.h",
+		"mapped_file.h", "mapped_file.cpp",
+		"binary_point_file.h", "binary_point_file.cpp",
+		"text_point_file.h", "text_point_file.cpp",
+		"hull_export.h", "hull_export.cpp",
+		"gKit/Geometry.cpp", "gKit/Geometry.h",
+		"gKit/Transform.cpp", "gKit/Transform.h"
+	}
+	includedirs { ".", "gKit" }
+
+	if os.is("windows") then
+		defines { "_USE_MATH_DEFINES", "_CRT_SECURE_NO_WARNINGS", "NOMINMAX" }
+	end
+
+	-- Headless command line tool
+	project "qhullcli"
+
+	kind "ConsoleApp"
+	files { "qhull_cli.cpp" }
+	includedirs { ".", "gKit" }
+	links { "qhullcore" }
+
+	if os.is("windows") then
+		defines { "_USE_MATH_DEFINES", "_CRT_SECURE_NO_WARNINGS", "NOMINMAX" }
+	end
+
+	-- Benchmark
+	project "qhullbench"
+
+	kind "ConsoleApp"
+	files { "qhull_bench.cpp" }
+	includedirs { ".", "gKit" }
+	links { "qhullcore" }
+
+	if os.is("windows") then
+		defines { "_USE_MATH_DEFINES", "_CRT_SECURE_NO_WARNINGS", "NOMINMAX" }
+	end
+
+	-- Viewer
 	project "qhull"
 
 	kind "ConsoleApp"
 	defines { "GK_OPENGL4", "VERBOSE" }
-	files { "*.h", "*.hpp", "*.cpp",
+	files { "main.cpp", "gl_*.h", "gl_*.cpp", "gkit_utils.h",
 		"gKit/*.cpp", "gKit/*.h",
 		"gKit/GL/*.cpp", "gKit/GL/*.h",
 		"gKit/Widgets/*.cpp", "gKit/Widgets/*.h"
 	}
+	excludes { "gKit/Geometry.cpp", "gKit/Transform.cpp" }
 	includedirs {
 		".",
 		"gKit",
 		"local/windows/include"
 	}
+	links { "qhullcore" }
 
 	configuration {"x32", "Debug"}
 		targetdir "Bin/Debug/x86"
@@ -1,35 +1,169 @@
 #include "qhull_3d.h"
-#include "jhull_2d.h"
+#include "mhull_2d.h"
+#include "parallel.h"
 
-#include <Transform.h>
+#include <algorithm>
+#include <cfloat>
 
-void QHull3d::initialize(const gk::Point* points, int count)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define QHULL_SSE2
+#endif
+
+#define KINETIC_EPSILON				1e-6f
+#define KINETIC_FLIP_BUDGET			8
+#define KINETIC_DEMOTION_TRIES		8
+#define KINETIC_DEMOTION_FACES		32
+#define KINETIC_REFLEX_FRACTION		0.125f
+#define CAVITY_REPAIR_MAX_ROUNDS	4
+#define SEED_MAX_FRACTION			0.5
+#define PARALLEL_PROJECTION_COUNT	(1 << 18)
+
+static_assert(sizeof(gk::Point) == 3 * sizeof(float) && sizeof(gk::Vec2) == 2 * sizeof(float), "Packed point layouts expected");
+
+//! Project the specified points (stride in bytes) onto a plane, given its coordinate system as the two affine rows computing the 2D coordinates.
+static void projectPoints(const char* points, size_t stride, int count, const float rows[2][4], gk::Vec2* projected)
+{
+	int i = 0;
+
+#ifdef QHULL_SSE2
+	// Packed points, 4 per step: deinterleave the coordinates, project, and interleave the results
+	const float* in = (const float*)points;
+	float* out = &projected[0].x;
+
+	__m128 r0x = _mm_set1_ps(rows[0][0]), r0y = _mm_set1_ps(rows[0][1]), r0z = _mm_set1_ps(rows[0][2]), r0w = _mm_set1_ps(rows[0][3]);
+	__m128 r1x = _mm_set1_ps(rows[1][0]), r1y = _mm_set1_ps(rows[1][1]), r1z = _mm_set1_ps(rows[1][2]), r1w = _mm_set1_ps(rows[1][3]);
+
+	for (; stride == sizeof(gk::Point) && i + 4 <= count; i += 4)
+	{
+		__m128 a = _mm_loadu_ps(in + 3 * i);		// x0 y0 z0 x1
+		__m128 b = _mm_loadu_ps(in + 3 * i + 4);	// y1 z1 x2 y2
+		__m128 c = _mm_loadu_ps(in + 3 * i + 8);	// z2 x3 y3 z3
+
+		__m128 x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+		__m128 y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+		__m128 z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+
+		__m128 u = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(r0x, x), _mm_mul_ps(r0y, y)), _mm_mul_ps(r0z, z)), r0w);
+		__m128 v = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(r1x, x), _mm_mul_ps(r1y, y)), _mm_mul_ps(r1z, z)), r1w);
+
+		_mm_storeu_ps(out + 2 * i, _mm_unpacklo_ps(u, v));
+		_mm_storeu_ps(out + 2 * i + 4, _mm_unpackhi_ps(u, v));
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		const gk::Point& p = *(const gk::Point*)(points + i * stride);
+
+		projected[i] = gk::Vec2(
+			rows[0][0] * p.x + rows[0][1] * p.y + rows[0][2] * p.z + rows[0][3],
+			rows[1][0] * p.x + rows[1][1] * p.y + rows[1][2] * p.z + rows[1][3]);
+	}
+}
+
+void QHull3d::initialize(const PointView3d& points, int count)
 {
+	QHULL_TRACE("initialize");
+
 	clear();
 
-	_points = points;
-	_pointcount = count;
+	setPoints(points, count);
 
 	createVertices();
 	createInitialTetrahedron();
+
+	countConflictMemory();
+	updateMemory(0);
+}
+void QHull3d::initialize(const PointView3d& points, int count, const std::vector<int>& seed)
+{
+	QHULL_TRACE("initialize");
+
+	clear();
+
+	setPoints(points, count);
+
+	createVertices();
+
+	// Degenerate, inconsistent or nearly complete seed: build cold, over fresh vertices if the seed's hull was started
+	if (!createSeedPolytope(seed))
+	{
+		if (!_faces.empty())
+		{
+			clear();
+
+			setPoints(points, count);
+
+			createVertices();
+		}
+
+		createInitialTetrahedron();
+	}
+
+	countConflictMemory();
+	updateMemory(0);
+}
+void QHull3d::setPoints(const PointView3d& points, int count)
+{
+	_pointcount = count;
+
+	if (points.type() == PointView3d::Float)
+	{
+		_points = points.base();
+		_pointstride = points.stride();
+
+		return;
+	}
+
+	// The distance computations being single precision, double precision points are rounded once
+	_convertedpoints.resize(count);
+
+	parallelFor(count, (count < PARALLEL_PROJECTION_COUNT) ? 1 : 0, [&](int, long long begin, long long end)
+	{
+		for (long long i = begin; i < end; ++i)
+			_convertedpoints[i] = points[(int)i];
+	});
+
+	_points = (count > 0) ? (const char*)&_convertedpoints[0] : nullptr;
+	_pointstride = sizeof(gk::Point);
 }
 void QHull3d::createVertices()
 {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
 	HEVertex* v;
+	gk::Vector extent;
 
 	_vertices.reserve(_pointcount);
 
 	for (int i = 0; i < _pointcount; ++i)
 	{
-		v = new HEVertex(_points);
+		v = new HEVertex(&point(i));
 		v->index = i;
 		v->edge = nullptr;
 
 		_vertices.push_back(std::unique_ptr<HEVertex>(v));
+
+		extent.x = std::max(extent.x, std::fabs(point(i).x));
+		extent.y = std::max(extent.y, std::fabs(point(i).y));
+		extent.z = std::max(extent.z, std::fabs(point(i).z));
 	}
+
+	// Distance computations' rounding error bound
+	_epsilon = QHULL_EPSILON_FACTOR * (extent.x + extent.y + extent.z);
+
+	_timings.vertices = elapsed(start);
+	QHullTrace::complete("createVertices", start);
+}
+void QHull3d::finishDegenerateSimplex(const std::chrono::steady_clock::time_point& start)
+{
+	_timings.simplex = elapsed(start);
+	_timings.partition = 0;
+	QHullTrace::complete("createInitialTetrahedron", start);
 }
 void QHull3d::createInitialTetrahedron()
 {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
 	float d;
 	float dmax;
 
@@ -42,32 +176,47 @@ void QHull3d::createInitialTetrahedron()
 
 	for (int i = 0; i < _pointcount; ++i)
 	{
-		const gk::Point& p = _points[i];
+		if (isRemoved(i))
+			continue;
+
+		const gk::Point& p = point(i);
 
-		if (epidx[0] < 0 || p.x < _points[epidx[0]].x)
+		if (epidx[0] < 0 || p.x < point(epidx[0]).x)
 			epidx[0] = i;
-		if (epidx[1] < 0 || p.x > _points[epidx[1]].x)
+		if (epidx[1] < 0 || p.x > point(epidx[1]).x)
 			epidx[1] = i;
 
-		if (epidx[2] < 0 || p.y < _points[epidx[2]].y)
+		if (epidx[2] < 0 || p.y < point(epidx[2]).y)
 			epidx[2] = i;
-		if (epidx[3] < 0 || p.y > _points[epidx[3]].y)
+		if (epidx[3] < 0 || p.y > point(epidx[3]).y)
 			epidx[3] = i;
 
-		if (epidx[4] < 0 || p.z < _points[epidx[4]].z)
+		if (epidx[4] < 0 || p.z < point(epidx[4]).z)
 			epidx[4] = i;
-		if (epidx[5] < 0 || p.z > _points[epidx[5]].z)
+		if (epidx[5] < 0 || p.z > point(epidx[5]).z)
 			epidx[5] = i;
 	}
 
+	// Classify the input dimension within the tolerance, and pick the simplex on the way
+	float tolerance = (_degeneracytolerance >= 0) ? _degeneracytolerance : _epsilon;
+
+	if (epidx[0] < 0)
+	{
+		_dimension = Empty;
+
+		finishDegenerateSimplex(start);
+		return;
+	}
+
 	// Find the most distant EP pair to build base triangle's first edge
 	dmax = 0.f;
+	tetraidx[0] = tetraidx[1] = epidx[0];
 
 	for (int i = 0; i < 5; ++i)
 	{
 		for (int j = i + 1; j < 6; ++j)
 		{
-			gk::Vector vij(_points[epidx[i]], _points[epidx[j]]);
+			gk::Vector vij(point(epidx[i]), point(epidx[j]));
 
 			if ((d = vij.LengthSquared()) > dmax)
 			{
@@ -79,41 +228,48 @@ void QHull3d::createInitialTetrahedron()
 		}
 	}
 
-	// Find the most distant EP from the first edge's support line to complete the base triangle
+	// Singular input: all the points within the tolerance of the first one
+	if (dmax <= tolerance * tolerance)
+	{
+		_dimension = Singular;
+		_degeneratehull.push_back(tetraidx[0]);
+
+		finishDegenerateSimplex(start);
+		return;
+	}
+
+	// Find the most distant point from the first edge's support line to complete the base triangle
 	dmax = 0.f;
 	tetraidx[2] = -1;
 
-	const gk::Point& t0 = _points[tetraidx[0]];
-	gk::Vector t01 = gk::Normalize(gk::Vector(t0, _points[tetraidx[1]]));
+	const gk::Point& t0 = point(tetraidx[0]);
+	gk::Vector t01(t0, point(tetraidx[1]));
 
-	for (int i = 0; i < 6; ++i)
+	for (int i = 0; i < _pointcount; ++i)
 	{
-		if (epidx[i] == tetraidx[0] || epidx[i] == tetraidx[1])
+		if (isRemoved(i))
 			continue;
 
-		gk::Vector t0i(t0, _points[epidx[i]]);
-		float pprojlength = gk::Dot(t0i, t01);
-		d = t0i.LengthSquared() - (pprojlength * pprojlength);
+		// Squared distance to the line times the edge's squared length: the cross product stays exact for aligned points
+		d = gk::Cross(gk::Vector(t0, point(i)), t01).LengthSquared();
 
 		if (d > dmax)
 		{
-			tetraidx[2] = epidx[i];
+			tetraidx[2] = i;
 
 			dmax = d;
 		}
 	}
 
-	// Special case where there are only 2 extreme points => Pick any remaining point
-	if (tetraidx[2] < 0)
+	// Linear input: the hull is the first edge
+	if (dmax <= tolerance * tolerance * t01.LengthSquared())
 	{
-		for (int i = 0; i < _pointcount; ++i)
-		{
-			if (i != tetraidx[0] && i != tetraidx[1])
-			{
-				tetraidx[2] = i;
-				break;
-			}
-		}
+		_dimension = Linear;
+		_degeneratehull.push_back(tetraidx[0]);
+		_degeneratehull.push_back(tetraidx[1]);
+
+		finishDegenerateSimplex(start);
+		return;
 	}
 
 	// Find the most distant point from the base triangle within the point cloud to complete the initial tetrahedron
@@ -122,11 +278,11 @@ void QHull3d::createInitialTetrahedron()
 
 	for (int i = 0; i < _pointcount; ++i)
 	{
-		if (i == tetraidx[0] || i == tetraidx[1] || i == tetraidx[2])
+		if (i == tetraidx[0] || i == tetraidx[1] || i == tetraidx[2] || isRemoved(i))
 			continue;
 
-		//if (fabs(d = tetrabase->distance(_points[i])) > fabs(dmax))
-		if (fabs(d = tetrabase->distance(_points[i])) >= fabs(dmax))
+		//if (fabs(d = tetrabase->distance(point(i))) > fabs(dmax))
+		if (fabs(d = tetrabase->distance(point(i))) >= fabs(dmax))
 		{
 			tetraidx[3] = i;
 
@@ -134,14 +290,19 @@ void QHull3d::createInitialTetrahedron()
 		}
 	}
 
-	// Coplanarity detection
-	if (dmax == 0)
+	// Planar input: hull the points projected onto the base triangle's plane
+	if (fabs(dmax) <= tolerance)
 	{
-		initialize2d();
+		_dimension = Planar;
 
+		initialize2d(tetraidx[0], tetraidx[1], tetraidx[2]);
+
+		finishDegenerateSimplex(start);
 		return;
 	}
 
+	_dimension = Volumetric;
+
 	// Reverse the base triangle if not counter clockwise oriented according to the tetrahedron outer surface
 	if (dmax > 0)
 		tetrabase->reverse();
@@ -150,111 +311,1167 @@ void QHull3d::createInitialTetrahedron()
 	std::vector<HEFace*> tetrafaces = extrudeOut(tetrabase, tetraidx[3]);
 	tetrafaces.insert(tetrafaces.begin(), tetrabase);
 
-	// Assign remaining points to their corresponding face
+	_timings.simplex = elapsed(start);
+	QHullTrace::complete("createInitialTetrahedron", start);
+	start = std::chrono::steady_clock::now();
+
+	// Assign remaining points to their corresponding face, by buckets of consecutive points
+	HEVertex* bucket[QHULL_CONFLICT_BUCKET_SIZE];
+	int bucketcount = 0;
+
 	for (int i = 0; i < _pointcount; ++i)
 	{
-		if (i == tetraidx[0] || i == tetraidx[1] || i == tetraidx[2] || i == tetraidx[3])
+		if (i == tetraidx[0] || i == tetraidx[1] || i == tetraidx[2] || i == tetraidx[3] || isRemoved(i))
 			continue;
 
-		for (int f = 0; f < (int)tetrafaces.size(); ++f)
+		bucket[bucketcount++] = _vertices[i].get();
+
+		if (bucketcount == QHULL_CONFLICT_BUCKET_SIZE)
 		{
-			if (tetrafaces[f]->tryAssignVertex(_vertices[i].get()))
-				break;
+			assignVertices(bucket, bucketcount, tetrafaces);
+			bucketcount = 0;
 		}
 	}
 
+	assignVertices(bucket, bucketcount, tetrafaces);
+
 	//! Add the tetrahedron's not empty faces to the processing stack
 	for (int i = 0; i < (int)tetrafaces.size(); ++i)
 		if (!tetrafaces[i]->vertices.empty())
 			_processingfaces.push(tetrafaces[i]);
 
+	_timings.partition = elapsed(start);
+	QHullTrace::complete("partition", start);
+
 	// Store hull first vertex
 	_hull = _vertices[tetraidx[0]].get();
 
 	//////////////////////////////////////////////////////////////////////////
 	// ToDo JRA: Remove this test code
 
+#ifdef _DEBUG
 	assertManifoldValidity(_hull);
+#endif
 }
 
-void QHull3d::initialize2d()
+//! Get the cell of the specified direction within a cube map of the specified resolution (cells per face side).
+static int cubeMapCell(const gk::Vector& d, int resolution)
 {
-	// Get plane's normal
-	gk::Point p0;
+	float ax = std::fabs(d.x), ay = std::fabs(d.y), az = std::fabs(d.z);
+	int side;
+	float u, v, m;
 
-	gk::Vector n;
-	gk::Vector v0;
-	gk::Vector v1;
+	if (ax >= ay && ax >= az)
+		side = (d.x < 0), u = d.y, v = d.z, m = ax;
+	else if (ay >= az)
+		side = 2 + (d.y < 0), u = d.z, v = d.x, m = ay;
+	else
+		side = 4 + (d.z < 0), u = d.x, v = d.y, m = az;
+
+	if (m == 0)
+		return 0;
+
+	int i = std::min((int)((u / m + 1) * 0.5f * resolution), resolution - 1);
+	int j = std::min((int)((v / m + 1) * 0.5f * resolution), resolution - 1);
+
+	return (side * resolution + std::max(j, 0)) * resolution + std::max(i, 0);
+}
+
+bool QHull3d::findSeedTetrahedron(const std::vector<int>& seed, int tetraidx[4]) const
+{
+	if (seed.size() < 4)
+		return false;
+
+	// Seed extreme points, then their most distant pair
+	int epidx[6];
+	for (int i = 0; i < 6; ++i)
+		epidx[i] = seed[0];
+
+	for (int i = 1; i < (int)seed.size(); ++i)
+	{
+		const gk::Point& p = point(seed[i]);
+
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			if (p[axis] < point(epidx[2 * axis])[axis])
+				epidx[2 * axis] = seed[i];
+			if (p[axis] > point(epidx[2 * axis + 1])[axis])
+				epidx[2 * axis + 1] = seed[i];
+		}
+	}
 
-	p0 = _points[0];
-	v0 = gk::Vector(p0, _points[1]);
+	float d;
+	float dmax = 0.f;
 
-	for (int i = 2; i < _pointcount; ++i)
+	for (int i = 0; i < 5; ++i)
 	{
-		n = gk::Cross(v0, gk::Vector(p0, _points[i]));
-		if (n.x != 0 || n.y != 0 || n.z != 0)
-			break;
+		for (int j = i + 1; j < 6; ++j)
+		{
+			if ((d = gk::Vector(point(epidx[i]), point(epidx[j])).LengthSquared()) > dmax)
+			{
+				tetraidx[0] = epidx[i];
+				tetraidx[1] = epidx[j];
+
+				dmax = d;
+			}
+		}
 	}
 
-	// Compute the plane's coordinate system
-	n = gk::Normalize(n);
-	v0 = gk::Normalize(v0);
-	v1 = gk::Cross(v0, n);
+	if (dmax <= _epsilon * _epsilon)
+		return false;
 
-	gk::Transform worldToPlane = gk::Transform({
-		v0.x,	v0.y,	v0.z,	-(v0.x * p0.x + v0.y * p0.y + v0.z * p0.z),
-		n.x,	n.y,	n.z,	-(n.x * p0.x + n.y * p0.y + n.z * p0.z),
-		v1.x,	v1.y,	v1.z,	-(v1.x * p0.x + v1.y * p0.y + v1.z * p0.z),
-		0,		0,		0,		1
-	});
+	// Most distant seed point from the first edge's support line
+	const gk::Point& t0 = point(tetraidx[0]);
+	gk::Vector t01(t0, point(tetraidx[1]));
 
-	// Move all point to the planar coordinate system
-	for (int i = 0; i < _pointcount; ++i)
+	dmax = 0.f;
+	for (int i = 0; i < (int)seed.size(); ++i)
 	{
-		gk::Point p = worldToPlane(_points[i]);
+		if ((d = gk::Cross(gk::Vector(t0, point(seed[i])), t01).LengthSquared()) > dmax)
+		{
+			tetraidx[2] = seed[i];
 
-		_points2d.push_back(gk::Vec2(p.x, p.z));
+			dmax = d;
+		}
 	}
 
-	// Initialize the computation of the 2D convex hull
-	_hull2d = std::make_unique<JHull2d>();
-	_hull2d->initialize(&_points2d[0], (int)_points2d.size());
-}
+	if (dmax <= _epsilon * _epsilon * t01.LengthSquared())
+		return false;
 
-std::vector<QHull3d::Face> QHull3d::hull() const
+	// Most distant seed point from the base triangle's plane
+	gk::Vector n = gk::Normalize(gk::Cross(t01, gk::Vector(t0, point(tetraidx[2]))));
+
+	dmax = 0.f;
+	for (int i = 0; i < (int)seed.size(); ++i)
+	{
+		if ((d = std::fabs(gk::Dot(n, gk::Vector(t0, point(seed[i]))))) > dmax)
+		{
+			tetraidx[3] = seed[i];
+
+			dmax = d;
+		}
+	}
+
+	return dmax > _epsilon;
+}
+bool QHull3d::createSeedPolytope(const std::vector<int>& seed)
 {
-	std::vector<Face> faces;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
 
-	if (_hull2d)
+	// Gather the valid seed vertices, once each
+	std::vector<char> inseed(_pointcount, 0);
+	std::vector<int> seedindices;
+
+	seedindices.reserve(seed.size());
+
+	for (int i = 0; i < (int)seed.size(); ++i)
 	{
-		std::vector<int> hullidx = _hull2d->hull();
-		
-		if (hullidx.size() > 2)
+		if (seed[i] < 0 || seed[i] >= _pointcount || isRemoved(seed[i]) || inseed[seed[i]])
+			continue;
+
+		inseed[seed[i]] = 1;
+		seedindices.push_back(seed[i]);
+	}
+
+	// A seed covering most of the points would cull few of them, for the price of a cold build
+	if (seedindices.size() > SEED_MAX_FRACTION * _pointcount)
+		return false;
+
+	int tetraidx[4];
+	if (!findSeedTetrahedron(seedindices, tetraidx))
+		return false;
+
+	// Hull the seed vertices in place, from their tetrahedron
+	HEFace* tetrabase = createFace(tetraidx[0], tetraidx[1], tetraidx[2]);
+	if (tetrabase->distance(point(tetraidx[3])) > 0)
+		tetrabase->reverse();
+
+	std::vector<HEFace*> tetrafaces = extrudeOut(tetrabase, tetraidx[3]);
+	tetrafaces.insert(tetrafaces.begin(), tetrabase);
+
+	std::vector<HEVertex*> seedvertices;
+	seedvertices.reserve(seedindices.size());
+
+	for (int i = 0; i < (int)seedindices.size(); ++i)
+	{
+		if (!_vertices[seedindices[i]]->edge)
+			seedvertices.push_back(_vertices[seedindices[i]].get());
+	}
+
+	if (!seedvertices.empty())
+		assignVertices(&seedvertices[0], (int)seedvertices.size(), tetrafaces);
+
+	for (int i = 0; i < (int)tetrafaces.size(); ++i)
+		if (!tetrafaces[i]->vertices.empty())
+			_processingfaces.push(tetrafaces[i]);
+
+	_hull = _vertices[tetraidx[0]].get();
+
+	while (iterate());
+
+	if (_failed)
+		return false;
+
+	std::vector<HEFace*> polytope = getConnectedFaces(_hull->edge->face);
+
+	// Compute an inner point and the radius of a ball centered on it, enclosed within the polytope
+	int hullvertexcount = 0;
+	gk::Vector sum;
+
+	for (int i = 0; i < (int)seedindices.size(); ++i)
+	{
+		if (_vertices[seedindices[i]]->edge)
 		{
-			faces.reserve(hullidx.size() - 2);
+			sum += gk::Vector(point(seedindices[i]));
+			++hullvertexcount;
+		}
+	}
 
-			for (int i = 1; i < (int)hullidx.size(); ++i)
-				faces.push_back({
-				hullidx[0],
-				hullidx[i - 1],
-				hullidx[i]
-			});
+	gk::Point center = gk::Point(sum / (float)hullvertexcount);
+
+	float innerradius = HUGE_VALF;
+	for (int f = 0; f < (int)polytope.size(); ++f)
+		innerradius = std::min(innerradius, -polytope[f]->distance(center));
+
+	float innerradius2 = innerradius > 0 ? innerradius * innerradius : 0;
+
+	_timings.simplex = elapsed(start);
+	QHullTrace::complete("createSeedPolytope", start);
+	start = std::chrono::steady_clock::now();
+
+	// Index the faces by their direction from the inner point, about one per cube map cell, for the walks to start nearby
+	int resolution = std::max(1, (int)std::sqrt(polytope.size() / 6.0));
+	std::vector<HEFace*> directions(6 * resolution * resolution, nullptr);
+
+	for (int f = 0; f < (int)polytope.size(); ++f)
+	{
+		const HEEdge* edge = polytope[f]->edge;
+		gk::Vector centroid = gk::Vector(center, edge->vertex->getPoint()) + gk::Vector(center, edge->next->vertex->getPoint()) +
+			gk::Vector(center, edge->next->next->vertex->getPoint());
+
+		directions[cubeMapCell(centroid, resolution)] = polytope[f];
+	}
+
+	// Cull the points inside the polytope and assign the others to the face they see
+	std::vector<int> walks(_faces.size(), -1);
+	HEFace* face = polytope[0];
+
+	for (int i = 0; i < _pointcount; ++i)
+	{
+		HEVertex* vertex = _vertices[i].get();
+
+		if (inseed[i] || isRemoved(i))
+			continue;
+
+		// Points within the inner ball: interior without any face lookup
+		const gk::Point& p = vertex->getPoint();
+		if (!_retaininteriors && gk::Vector(center, p).LengthSquared() < innerradius2)
+			continue;
+
+		// Walk from the face indexed in the point's direction, or from the previous point's face
+		HEFace* startface = directions[cubeMapCell(gk::Vector(center, p), resolution)];
+		HEFace* coneface = locateFace(startface ? startface : face, center, p, i, walks);
+		if (coneface)
+		{
+			face = coneface;
+
+			QHULL_STAT(++_stats.distancetests);
+
+			if (!face->tryAssignVertex(vertex, _epsilon) && _retaininteriors)
+				face->retainVertex(vertex);
+		}
+		else
+		{
+			int f;
+			for (f = 0; f < (int)polytope.size(); ++f)
+			{
+				QHULL_STAT(++_stats.distancetests);
+
+				if (polytope[f]->tryAssignVertex(vertex, _epsilon))
+					break;
+			}
+
+			if (f == (int)polytope.size() && _retaininteriors)
+				retainVertex(polytope, vertex);
 		}
 	}
 
-	if (_hull)
+	// Process the furthest extreme points first
+	std::vector<HEFace*> conflictfaces;
+	for (int f = 0; f < (int)polytope.size(); ++f)
+		if (!polytope[f]->vertices.empty())
+			conflictfaces.push_back(polytope[f]);
+
+	std::sort(conflictfaces.begin(), conflictfaces.end(), [](const HEFace* f1, const HEFace* f2)
 	{
-		std::vector<HEFace*> hullfaces = _hull->getConnectedFaces();
+		return f1->extremeDistance() < f2->extremeDistance();
+	});
 
-		faces.reserve(hullfaces.size());
+	for (int f = 0; f < (int)conflictfaces.size(); ++f)
+		_processingfaces.push(conflictfaces[f]);
 
-		for (int i = 0; i < (int)hullfaces.size(); ++i)
-			faces.push_back({
-			hullfaces[i]->edge->vertex->index,
-			hullfaces[i]->edge->next->vertex->index,
-			hullfaces[i]->edge->next->next->vertex->index
+	_timings.partition = elapsed(start);
+	QHullTrace::complete("partition", start);
+
+	// Store hull first vertex
+	_hull = polytope[0]->edge->vertex;
+
+	//////////////////////////////////////////////////////////////////////////
+	// ToDo JRA: Remove this test code
+
+#ifdef _DEBUG
+	assertManifoldValidity(_hull);
+#endif
+
+	return true;
+}
+
+void QHull3d::initialize2d(int p0idx, int p1idx, int p2idx)
+{
+	// Get plane's normal
+	gk::Point p0 = point(p0idx);
+
+	gk::Vector v0 = gk::Vector(p0, point(p1idx));
+	gk::Vector n = gk::Cross(v0, gk::Vector(p0, point(p2idx)));
+	gk::Vector v1;
+
+	PointView2d view;
+
+	if ((n.x != 0) + (n.y != 0) + (n.z != 0) == 1)
+	{
+		// Axis aligned plane: read the two other coordinates in place
+		const float* coordinates = &point(0).x;
+
+		view = PointView2d(coordinates + ((n.x != 0) ? 1 : 0), coordinates + ((n.z != 0) ? 1 : 2), _pointstride / sizeof(float));
+	}
+	else
+	{
+		// Compute the plane's coordinate system
+		n = gk::Normalize(n);
+		v0 = gk::Normalize(v0);
+		v1 = gk::Cross(v0, n);
+
+		const float rows[2][4] = {
+			{ v0.x,	v0.y,	v0.z,	-(v0.x * p0.x + v0.y * p0.y + v0.z * p0.z) },
+			{ v1.x,	v1.y,	v1.z,	-(v1.x * p0.x + v1.y * p0.y + v1.z * p0.z) }
+		};
+
+		// Move all point to the planar coordinate system
+		_points2d.resize(_pointcount);
+
+		parallelFor(_pointcount, (_pointcount < PARALLEL_PROJECTION_COUNT) ? 1 : 0, [&](int, long long begin, long long end)
+		{
+			projectPoints(_points + begin * _pointstride, _pointstride, (int)(end - begin), rows, &_points2d[begin]);
 		});
+
+		view = PointView2d(&_points2d[0]);
 	}
 
-	return faces;
+	// Initialize the computation of the 2D convex hull
+	_hull2d = std::make_unique<MHull2d>();
+	_hull2d->initialize(view, _pointcount);
+}
+
+void QHull3d::rebuild()
+{
+	std::vector<char> removed = std::move(_removed);
+
+	std::vector<gk::Point> convertedpoints = std::move(_convertedpoints);
+	const char* points = _points;
+	size_t pointstride = _pointstride;
+	int pointcount = _pointcount;
+
+	clear();
+
+	_convertedpoints = std::move(convertedpoints);
+	_points = points;
+	_pointstride = pointstride;
+	_pointcount = pointcount;
+	_removed = std::move(removed);
+
+	createVertices();
+	createInitialTetrahedron();
+
+	countConflictMemory();
+	updateMemory(0);
+
+	build();
+}
+
+void QHull3d::countConflictMemory()
+{
+	_memory.conflicts = 0;
+	for (int f = 0; f < (int)_faces.size(); ++f)
+		_memory.conflicts += conflictMemory(_faces[f].get());
+}
+
+bool QHull3d::removePoint(int index)
+{
+	if (!_retaininteriors || !_hull || _hull2d || !_processingfaces.empty())
+		return false;
+	if (index < 0 || index >= _pointcount || isRemoved(index))
+		return false;
+
+	HEVertex* vertex = _vertices[index].get();
+
+	if (_removed.empty())
+		_removed.resize(_pointcount, 0);
+	_removed[index] = 1;
+
+	// Interior point case
+	if (vertex->bucket)
+	{
+		HEFace::releaseVertex(vertex);
+
+		return true;
+	}
+	if (!vertex->edge)
+		return true;
+
+	// Hull vertex case
+	std::vector<HEFace*> cap;
+
+	if (!repairCavity(vertex, false, cap))
+	{
+		rebuild();
+
+		_repairpointcount = _pointcount;
+	}
+	else
+	{
+		countConflictMemory();
+		updateMemory(0);
+	}
+
+	return true;
+}
+bool QHull3d::repairCavity(HEVertex* vertex, bool demote, std::vector<HEFace*>& capfaces)
+{
+	// Gather the faces incident to the vertex and the edge loop bordering them
+	std::vector<HEFace*> fan;
+	std::vector<HEEdge*> link;
+
+	HEEdge* edge = vertex->edge;
+	do
+	{
+		fan.push_back(edge->face);
+		link.push_back(edge->next);
+
+		edge = edge->next->next->coedge;
+	} while (edge != vertex->edge);
+
+	// Gather the cavity points: link vertices and the fan's retained interior points
+	std::vector<HEVertex*> candidates;
+
+	for (int i = 0; i < (int)link.size(); ++i)
+		candidates.push_back(link[i]->vertex);
+
+	for (int f = 0; f < (int)fan.size(); ++f)
+		candidates.insert(candidates.end(), fan[f]->interiors.begin(), fan[f]->interiors.end());
+
+	// Gather the ring: the faces around the link vertices, outside the fan
+	std::vector<HEFace*> ring;
+
+	for (int i = 0; i < (int)link.size(); ++i)
+	{
+		HEEdge* e = link[i]->vertex->edge;
+		do
+		{
+			if (std::find(fan.begin(), fan.end(), e->face) == fan.end())
+				ring.push_back(e->face);
+
+			e = e->next->next->coedge;
+		} while (e != link[i]->vertex->edge);
+	}
+
+	std::sort(ring.begin(), ring.end());
+	ring.erase(std::unique(ring.begin(), ring.end()), ring.end());
+
+	// Select the cap, pulling in the ring's retained points it leaves outside: points on the fan's planes
+	// may have been retained by a coplanar ring face (coplanar inputs)
+	const long long loopsize = (long long)link.size();
+	const int fancandidatecount = (int)candidates.size();
+
+	std::vector<Face> cap;
+
+	for (int round = 0; ; ++round)
+	{
+		_repairpointcount = (int)candidates.size();
+
+		if (!selectCap(candidates, loopsize, cap))
+			return false;
+
+		std::vector<gk::Vector> normals(cap.size());
+		std::vector<float> offsets(cap.size());
+
+		for (int f = 0; f < (int)cap.size(); ++f)
+		{
+			const gk::Point& a = candidates[cap[f].idx[0]]->getPoint();
+			gk::Vector n = gk::Cross(gk::Vector(a, candidates[cap[f].idx[1]]->getPoint()), gk::Vector(a, candidates[cap[f].idx[2]]->getPoint()));
+
+			normals[f] = (n.LengthSquared() > 0) ? gk::Normalize(n) : n;
+			offsets[f] = -gk::Dot(normals[f], gk::Vector(a));
+		}
+
+		int candidatecount = (int)candidates.size();
+
+		for (int r = 0; r < (int)ring.size(); ++r)
+		{
+			for (int i = 0; i < (int)ring[r]->interiors.size(); ++i)
+			{
+				HEVertex* v = ring[r]->interiors[i];
+				gk::Vector p(v->getPoint());
+
+				for (int f = 0; f < (int)cap.size(); ++f)
+				{
+					if (gk::Dot(normals[f], p) + offsets[f] > _epsilon)
+					{
+						if (std::find(candidates.begin() + fancandidatecount, candidates.end(), v) == candidates.end())
+							candidates.push_back(v);
+
+						break;
+					}
+				}
+			}
+		}
+
+		if ((int)candidates.size() == candidatecount)
+			break;
+
+		// Still escaping points after the last round: leave the cavity to a rebuild
+		if (round == CAVITY_REPAIR_MAX_ROUNDS)
+			return false;
+	}
+
+	// Index the loop edges to sew the cap onto the remaining surface
+	std::unordered_map<long long, HEEdge*> borders;
+
+	for (int i = 0; i < (int)link.size(); ++i)
+	{
+		HEEdge* e = link[i];
+		long long key = ((long long)e->next->next->vertex->index << 32) | (unsigned int)e->vertex->index;
+
+		borders[key] = e->coedge;
+	}
+
+	// Check the cap boundary before modifying the mesh
+	std::unordered_map<long long, int> capedges;
+
+	for (int f = 0; f < (int)cap.size(); ++f)
+	{
+		for (int i = 0; i < 3; ++i)
+		{
+			long long from = candidates[cap[f].idx[i]]->index;
+			long long to = candidates[cap[f].idx[(i + 1) % 3]]->index;
+
+			capedges[(from << 32) | (unsigned int)to]++;
+		}
+	}
+
+	int bordercount = 0;
+	for (auto it = capedges.begin(); it != capedges.end(); ++it)
+	{
+		long long from = it->first >> 32;
+		long long to = it->first & 0xffffffff;
+
+		if (it->second != 1)
+			return false;
+
+		if (!capedges.count((to << 32) | from))
+		{
+			if (!borders.count(it->first))
+				return false;
+
+			++bordercount;
+		}
+	}
+	if (bordercount != (int)borders.size())
+		return false;
+
+	// Cap edges joining two non consecutive link vertices must not already exist outside the cavity
+	for (int f = 0; f < (int)cap.size(); ++f)
+	{
+		for (int i = 0; i < 3; ++i)
+		{
+			long long from = cap[f].idx[i];
+			long long to = cap[f].idx[(i + 1) % 3];
+
+			if (from >= loopsize || to >= loopsize || from == (to + 1) % loopsize || to == (from + 1) % loopsize)
+				continue;
+
+			HEEdge* e = candidates[from]->edge;
+			do
+			{
+				if (e->vertex == candidates[to])
+					return false;
+
+				e = e->next->next->coedge;
+			} while (e != candidates[from]->edge);
+		}
+	}
+
+	// Release the pulled ring points and the fan's retained interior points
+	for (int i = fancandidatecount; i < (int)candidates.size(); ++i)
+		HEFace::releaseVertex(candidates[i]);
+
+	for (int f = 0; f < (int)fan.size(); ++f)
+	{
+		std::vector<HEVertex*>& interiors = fan[f]->interiors;
+
+		for (int i = 0; i < (int)interiors.size(); ++i)
+		{
+			interiors[i]->bucket = nullptr;
+			interiors[i]->bucketslot = -1;
+		}
+
+		interiors.clear();
+	}
+
+	// Build and sew the cap
+	capfaces = createMesh(cap, candidates, borders);
+
+	// Retain the remaining cavity points
+	for (int i = (int)link.size(); i < (int)candidates.size(); ++i)
+		if (!candidates[i]->edge)
+			retainVertex(capfaces, candidates[i]);
+
+	// Detach the removed vertex and its incident faces
+	for (int f = 0; f < (int)fan.size(); ++f)
+		fan[f]->edge = nullptr;
+
+	vertex->edge = nullptr;
+
+	if (demote)
+		retainVertex(capfaces, vertex);
+
+	if (_hull == vertex)
+		_hull = candidates[0];
+
+	//////////////////////////////////////////////////////////////////////////
+	// ToDo JRA: Remove this test code
+
+#ifdef _DEBUG
+	assertManifoldValidity(_hull);
+#endif
+
+	return true;
+}
+
+bool QHull3d::selectCap(const std::vector<HEVertex*>& candidates, long long loopsize, std::vector<Face>& cap) const
+{
+	std::vector<gk::Point> candidatepoints;
+
+	candidatepoints.reserve(candidates.size());
+	for (int i = 0; i < (int)candidates.size(); ++i)
+		candidatepoints.push_back(candidates[i]->getPoint());
+
+	// Build the cavity points' hull
+	QHull3d cavityhull;
+	cavityhull.initialize(&candidatepoints[0], (int)candidatepoints.size());
+	cavityhull.build();
+
+	if (cavityhull.failed())
+		return false;
+
+	// Select the cap: the cavity hull's faces enclosed by the link loop, on the side the loop borders
+	// (local indices: the link vertex k is the candidate k, reached from the link vertex k - 1)
+	std::vector<Face> faces = cavityhull.hull();
+
+	cap.clear();
+
+	std::unordered_map<long long, int> owners;
+	for (int f = 0; f < (int)faces.size(); ++f)
+		for (int i = 0; i < 3; ++i)
+			owners[((long long)faces[f].idx[i] << 32) | faces[f].idx[(i + 1) % 3]] = f;
+
+	// Coplanar cavity hull: orient its faces along the loop
+	if (cavityhull._hull2d && !owners.count(((loopsize - 1) << 32) | 0))
+	{
+		owners.clear();
+
+		for (int f = 0; f < (int)faces.size(); ++f)
+		{
+			std::swap(faces[f].idx[1], faces[f].idx[2]);
+
+			for (int i = 0; i < 3; ++i)
+				owners[((long long)faces[f].idx[i] << 32) | faces[f].idx[(i + 1) % 3]] = f;
+		}
+	}
+
+	std::vector<char> incap(faces.size(), 0);
+	std::vector<int> pending;
+
+	for (long long k = 0; k < loopsize; ++k)
+	{
+		auto owner = owners.find((((k + loopsize - 1) % loopsize) << 32) | k);
+		if (owner == owners.end())
+			return false;
+
+		if (!incap[owner->second])
+		{
+			incap[owner->second] = 1;
+			pending.push_back(owner->second);
+		}
+	}
+
+	while (!pending.empty())
+	{
+		const Face& face = faces[pending.back()];
+		pending.pop_back();
+
+		for (int i = 0; i < 3; ++i)
+		{
+			long long from = face.idx[i];
+			long long to = face.idx[(i + 1) % 3];
+
+			// Do not cross the loop
+			if (from < loopsize && to < loopsize && from == (to + loopsize - 1) % loopsize)
+				continue;
+
+			auto neighbor = owners.find((to << 32) | from);
+			if (neighbor != owners.end() && !incap[neighbor->second])
+			{
+				incap[neighbor->second] = 1;
+				pending.push_back(neighbor->second);
+			}
+		}
+	}
+
+	for (int f = 0; f < (int)faces.size(); ++f)
+		if (incap[f])
+			cap.push_back(faces[f]);
+
+	return true;
+}
+
+int QHull3d::update(const PointView3d& points)
+{
+	setPoints(points, _pointcount);
+
+	for (int i = 0; i < _pointcount; ++i)
+		_vertices[i]->setPoint(&point(i));
+
+	if (!_retaininteriors || !_hull || _hull2d || !_processingfaces.empty())
+	{
+		rebuild();
+
+		return -1;
+	}
+
+	int repairs = 0;
+
+	std::vector<HEFace*> faces = getConnectedFaces(_hull->edge->face);
+
+	// Re-evaluate the support planes
+	float scale = 0;
+
+	for (int f = 0; f < (int)faces.size(); ++f)
+	{
+		faces[f]->updateSupportPlane();
+
+		const gk::Point& p = faces[f]->edge->vertex->getPoint();
+		scale = std::max(scale, std::max(std::fabs(p.x), std::max(std::fabs(p.y), std::fabs(p.z))));
+	}
+
+	float epsilon = scale * KINETIC_EPSILON;
+
+	// Flip the reflex edges until the surface is locally convex
+	std::vector<HEEdge*> pending;
+	std::vector<HEEdge*> stuck;
+
+	pending.reserve(faces.size() * 3);
+
+	for (int f = 0; f < (int)faces.size(); ++f)
+	{
+		pending.push_back(faces[f]->edge);
+		pending.push_back(faces[f]->edge->next);
+		pending.push_back(faces[f]->edge->next->next);
+	}
+
+	// A motion folding a large share of the edges is out of local repairs' reach: rebuild right away
+	int reflexcount = 0;
+	for (int e = 0; e < (int)pending.size(); ++e)
+		reflexcount += isReflex(pending[e], epsilon);
+
+	if (reflexcount > KINETIC_REFLEX_FRACTION * pending.size())
+	{
+		rebuild();
+
+		return -1;
+	}
+
+	int flipbudget = KINETIC_FLIP_BUDGET * (int)faces.size();
+	int demotionbudget = std::max((int)faces.size() / KINETIC_DEMOTION_FACES, 1);
+
+	while (!pending.empty() || !stuck.empty())
+	{
+		// Flip the pending reflex edges, putting aside the ones that cannot be flipped yet
+		bool flipped = false;
+
+		while (!pending.empty() || (!flipped && !stuck.empty()))
+		{
+			HEEdge* edge;
+
+			if (!pending.empty())
+			{
+				edge = pending.back();
+				pending.pop_back();
+			}
+			else
+			{
+				// Retry the put aside edges once their neighborhood has changed
+				pending.swap(stuck);
+				flipped = true;
+
+				continue;
+			}
+
+			if (!edge->face->edge || !isReflex(edge, epsilon))
+				continue;
+
+			if (!flipEdge(edge, epsilon))
+			{
+				stuck.push_back(edge);
+
+				continue;
+			}
+
+			if (flipbudget-- == 0)
+			{
+				rebuild();
+
+				return -1;
+			}
+
+			pending.push_back(edge->next);
+			pending.push_back(edge->next->next);
+			pending.push_back(edge->coedge->next);
+			pending.push_back(edge->coedge->next->next);
+
+			flipped = false;
+			++repairs;
+		}
+
+		if (stuck.empty())
+			break;
+
+		// No flip possible anymore: demote a vertex bordering a stuck edge, usually sunk below its 3 neighbors,
+		// trying the lowest degree ones first (a wrongly demoted vertex is extruded back as an escaping point)
+		std::vector<std::pair<int, HEVertex*>> sunk;
+
+		for (int i = 0; i < (int)stuck.size(); ++i)
+		{
+			if (!stuck[i]->face->edge)
+				continue;
+
+			HEVertex* ends[2] = { stuck[i]->next->next->vertex, stuck[i]->vertex };
+			for (int v = 0; v < 2; ++v)
+			{
+				int degree = 0;
+
+				HEEdge* e = ends[v]->edge;
+				do
+				{
+					++degree;
+					e = e->next->next->coedge;
+				} while (e != ends[v]->edge);
+
+				sunk.push_back(std::make_pair(degree, ends[v]));
+			}
+		}
+
+		std::sort(sunk.begin(), sunk.end());
+		sunk.erase(std::unique(sunk.begin(), sunk.end()), sunk.end());
+
+		// Many or failing demotions tell a motion too large for local repairs: rebuilding is then cheaper
+		std::vector<HEFace*> cap;
+
+		int s;
+		for (s = 0; s < std::min((int)sunk.size(), KINETIC_DEMOTION_TRIES); ++s)
+			if (repairCavity(sunk[s].second, true, cap))
+				break;
+
+		if (s == std::min((int)sunk.size(), KINETIC_DEMOTION_TRIES) || demotionbudget-- == 0)
+		{
+			rebuild();
+
+			return -1;
+		}
+
+		++repairs;
+
+		pending.swap(stuck);
+		for (int f = 0; f < (int)cap.size(); ++f)
+		{
+			pending.push_back(cap[f]->edge);
+			pending.push_back(cap[f]->edge->next);
+			pending.push_back(cap[f]->edge->next->next);
+		}
+	}
+
+	// Check the repaired surface before trusting it: a fold left by the flips would lose points
+	faces = getConnectedFaces(_hull->edge->face);
+
+	gk::Point center;
+	if (!isConvexSurface(faces, epsilon, center))
+	{
+		rebuild();
+
+		return -1;
+	}
+
+	// Extrude the retained interior points escaping the hull, through the face whose cone (apexed at the inner point) contains them
+	std::vector<int> walks(_faces.size(), -1);
+
+	for (int f = 0; f < (int)faces.size(); ++f)
+	{
+		HEFace* face = faces[f];
+
+		for (int i = (int)face->interiors.size() - 1; i >= 0; --i)
+		{
+			HEVertex* vertex = face->interiors[i];
+
+			HEFace* coneface = locateFace(face, center, vertex->getPoint(), vertex->index, walks);
+			if (!coneface)
+			{
+				rebuild();
+
+				return -1;
+			}
+
+			if (coneface->distance(vertex->getPoint()) > _epsilon)
+			{
+				HEFace::releaseVertex(vertex);
+
+				if (coneface->vertices.empty())
+					_processingfaces.push(coneface);
+				coneface->tryAssignVertex(vertex, _epsilon);
+
+				++repairs;
+			}
+		}
+	}
+
+	countConflictMemory();
+	updateMemory(0);
+
+	build();
+
+	return repairs;
+}
+
+bool QHull3d::isConvexSurface(const std::vector<HEFace*>& faces, float epsilon, gk::Point& center) const
+{
+	gk::Vector sum;
+
+	for (int f = 0; f < (int)faces.size(); ++f)
+	{
+		const HEEdge* edge = faces[f]->edge;
+		sum += gk::Vector(edge->vertex->getPoint()) + gk::Vector(edge->next->vertex->getPoint()) + gk::Vector(edge->next->next->vertex->getPoint());
+	}
+
+	center = gk::Point(sum / (3.0f * faces.size()));
+
+	// Faces oriented away from the inner point, and no reflex edge
+	for (int f = 0; f < (int)faces.size(); ++f)
+	{
+		if (faces[f]->distance(center) >= 0)
+			return false;
+
+		const HEEdge* edge = faces[f]->edge;
+		for (int e = 0; e < 3; ++e, edge = edge->next)
+		{
+			if (isReflex(edge, epsilon))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+std::vector<QHull3d::HEFace*> QHull3d::createMesh(const std::vector<Face>& faces, const std::vector<HEVertex*>& vertices, const std::unordered_map<long long, HEEdge*>& borders)
+{
+	std::unordered_map<long long, HEEdge*> sewing;
+	std::vector<HEFace*> newfaces;
+
+	newfaces.reserve(faces.size());
+
+	for (int f = 0; f < (int)faces.size(); ++f)
+	{
+		HEFace* face = createFace(
+			vertices[faces[f].idx[0]]->index,
+			vertices[faces[f].idx[1]]->index,
+			vertices[faces[f].idx[2]]->index);
+
+		HEEdge* e = face->edge;
+		for (int i = 0; i < 3; ++i, e = e->next)
+		{
+			long long from = e->next->next->vertex->index;
+			long long to = e->vertex->index;
+			long long key = (from << 32) | to;
+
+			auto border = borders.find(key);
+			if (border != borders.end())
+			{
+				e->coedge = border->second;
+				border->second->coedge = e;
+
+				continue;
+			}
+
+			auto coedge = sewing.find((to << 32) | from);
+			if (coedge != sewing.end())
+			{
+				e->coedge = coedge->second;
+				coedge->second->coedge = e;
+
+				sewing.erase(coedge);
+			}
+			else
+			{
+				sewing[key] = e;
+			}
+		}
+
+		newfaces.push_back(face);
+	}
+
+	return newfaces;
+}
+
+std::vector<QHull3d::Face> QHull3d::hull() const
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::vector<Face> faces;
+
+	if (_hull2d)
+	{
+		std::vector<int> hullidx = _hull2d->hull();
+		
+		if (hullidx.size() > 2)
+		{
+			faces.reserve(hullidx.size() - 2);
+
+			for (int i = 2; i < (int)hullidx.size(); ++i)
+				faces.push_back({
+				hullidx[0],
+				hullidx[i - 1],
+				hullidx[i]
+			});
+		}
+	}
+
+	if (_hull)
+	{
+		std::vector<HEFace*> hullfaces = getConnectedFaces(_hull->edge->face);
+
+		faces.reserve(hullfaces.size());
+
+		for (int i = 0; i < (int)hullfaces.size(); ++i)
+			faces.push_back({
+			hullfaces[i]->edge->vertex->index,
+			hullfaces[i]->edge->next->vertex->index,
+			hullfaces[i]->edge->next->next->vertex->index
+		});
+	}
+
+	_timings.extraction = elapsed(start);
+	QHullTrace::complete("hull", start);
+
+	return faces;
+}
+std::vector<int> QHull3d::hullVertices() const
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::vector<int> vertices;
+
+	if (_hull2d)
+		vertices = _hull2d->hull();
+	else if (_hull)
+	{
+		// Each vertex is listed by the face of its own emanating half-edge
+		visitConnectedFaces(_hull->edge->face, [&](HEFace* face)
+		{
+			HEEdge* edge = face->edge;
+			for (int e = 0; e < 3; ++e, edge = edge->next)
+			{
+				if (edge->vertex->edge == edge->next)
+					vertices.push_back(edge->vertex->index);
+			}
+		});
+	}
+	else
+		vertices = _degeneratehull;
+
+	std::sort(vertices.begin(), vertices.end());
+
+	_timings.extraction = elapsed(start);
+	QHullTrace::complete("hullVertices", start);
+
+	return vertices;
+}
+QHull3d::Mesh QHull3d::mesh() const
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	Mesh mesh;
+
+	if (_hull)
+	{
+		std::vector<HEFace*> hullfaces = getConnectedFaces(_hull->edge->face);
+		int facecount = (int)hullfaces.size();
+
+		// Number the faces by slot
+		std::vector<int> faceindices(_faces.size(), -1);
+		for (int f = 0; f < facecount; ++f)
+			faceindices[hullfaces[f]->id] = f;
+
+		mesh.faces.reserve(facecount);
+		mesh.neighbors.resize(facecount * 3);
+		mesh.edges.reserve(facecount * 3 / 2);
+		mesh.vertices.reserve(facecount / 2 + 2);
+		mesh.fanoffsets.reserve(facecount / 2 + 3);
+		mesh.fanfaces.reserve(facecount * 3);
+
+		for (int f = 0; f < facecount; ++f)
+		{
+			HEEdge* edges[3] = { hullfaces[f]->edge, hullfaces[f]->edge->next, hullfaces[f]->edge->next->next };
+			Face face(edges[0]->vertex->index, edges[1]->vertex->index, edges[2]->vertex->index);
+
+			mesh.faces.push_back(face);
+
+			for (int k = 0; k < 3; ++k)
+			{
+				// Half-edge from idx[k] to idx[k + 1], the edge being listed by its lowest numbered face
+				HEEdge* edge = edges[(k + 1) % 3];
+				int neighbor = edge->coedge ? faceindices[edge->coedge->face->id] : -1;
+
+				mesh.neighbors[f * 3 + k] = neighbor;
+
+				if (f < neighbor)
+					mesh.edges.push_back({ { face.idx[k], face.idx[(k + 1) % 3] }, { f, neighbor } });
+
+				// Vertex fan, listed by the face of the vertex's own emanating half-edge and walked through the co-edges
+				HEVertex* vertex = edges[k]->vertex;
+				if (vertex->edge == edge)
+				{
+					mesh.vertices.push_back(vertex->index);
+					mesh.fanoffsets.push_back((int)mesh.fanfaces.size());
+
+					HEEdge* fanedge = edge;
+					do
+					{
+						mesh.fanfaces.push_back(faceindices[fanedge->face->id]);
+						fanedge = fanedge->next->next->coedge;
+					} while (fanedge && fanedge != edge);
+				}
+			}
+		}
+
+		mesh.fanoffsets.push_back((int)mesh.fanfaces.size());
+	}
+
+	_timings.extraction = elapsed(start);
+	QHullTrace::complete("mesh", start);
+
+	return mesh;
 }
\ No newline at end of file
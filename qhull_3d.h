@@ -3,12 +3,23 @@
 
 #include "convex_hull_3d.h"
 #include "convex_hull_2d.h"
+#include "qhull_stats.h"
+#include "qhull_trace.h"
 
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
 #include <vector>
 #include <stack>
 #include <unordered_map>
 #include <memory>
 
+#define QHULL_TRACE_ITERATION_BATCH		256
+#define QHULL_EPSILON_FACTOR			(3 * FLT_EPSILON)
+#define QHULL_CONFLICT_BUCKET_SIZE		64
+#define QHULL_CONFLICT_BUCKET_MIN		8
+
 //! Quick hull algorithm implementation for 3D convex hull (O(n log(n)) average complexity).
 //! http://www.cise.ufl.edu/~ungor/courses/fall06/papers/QuickHull.pdf
 //! Fall back to a 2D algorithm when all the specified points are coplanar.
@@ -29,8 +40,8 @@ private:
 	{
 	private:
 
-		//! Global point set.
-		const gk::Point* _points;
+		//! Point coordinates, within the input or converted point set.
+		const gk::Point* _point;
 
 	public:
 
@@ -38,12 +49,14 @@ private:
 
 		HEEdge* edge;	//! One of the half-edges emanating from the vertex
 
-		HEVertex(const gk::Point* points) : _points(points), index(-1), edge(nullptr) {}
+		HEFace* bucket;		//! Face retaining the vertex as an interior point (retention mode only)
+		int bucketslot;		//! Position within the retaining face's interior vertex list
 
-		const gk::Point& getPoint() const { return _points[index]; }
+		HEVertex(const gk::Point* point) : _point(point), index(-1), edge(nullptr), bucket(nullptr), bucketslot(-1) {}
 
-		//! Get all the faces connected to this vertex.
-		std::vector<HEFace*> getConnectedFaces() const;
+		const gk::Point& getPoint() const { return *_point; }
+		//! Set the point coordinates' location (the point set having moved).
+		void setPoint(const gk::Point* point) { _point = point; }
 	};
 
 	//! Half-edge.
@@ -51,7 +64,7 @@ private:
 	{
 	public:
 
-		int id;				//! Edge unique identifier
+		int id;				//! Edge unique identifier, its slot within the hull's edge set
 
 		HEVertex* vertex;	//! Vertex at the end of the half-edge
 
@@ -75,13 +88,14 @@ private:
 
 	public:
 
-		int id;								//! Face unique identifier
+		int id;								//! Face unique identifier, its slot within the hull's face set
 
 		HEEdge* edge;						//! One of the half-edges bordering the face
 
 		int iterationid;					//! Iteration identifier
 
 		std::vector<HEVertex*> vertices;	//! Visible vertices
+		std::vector<HEVertex*> interiors;	//! Retained interior vertices (retention mode only)
 
 		HEFace() : edge(nullptr), iterationid(-1), _d(0.f), _extremedistance(0.f) {}
 
@@ -90,8 +104,6 @@ private:
 
 		//! Get adjacent faces.
 		std::vector<HEFace*> getAdjacentFaces() const;
-		//! Get all connected faces.
-		std::vector<HEFace*> getConnectedFaces() const;
 
 		//! Reverse the face orientation.
 		void reverse();
@@ -100,17 +112,33 @@ private:
 		void updateSupportPlane();
 
 		//! Try to assign the specified vertex into the visible set.
-		//! The assignment is performed if the vertex is visible.
+		//! The assignment is performed if the vertex is visible, i.e. further than epsilon above the face.
 		//! Returns true if the assignment was successful, false otherwise.
-		bool tryAssignVertex(HEVertex* v);
+		bool tryAssignVertex(HEVertex* v, float epsilon);
+
+		//! Retain the specified vertex as an interior point of the face.
+		void retainVertex(HEVertex* v);
+		//! Release the specified vertex from its retaining face, in constant time.
+		static void releaseVertex(HEVertex* v);
+
+		//! Get the furthest assigned vertex distance.
+		float extremeDistance() const { return _extremedistance; }
 
+		//! Get the unit normal.
+		const gk::Vector& normal() const { return _n; }
 		//! Get the signed orthogonal distance to the specified point, according to the normal direction.
 		float distance(const gk::Point& p) const { return _n.x * p.x + _n.y * p.y + _n.z * p.z + _d; }
+		//! Returns true if the specified point's projection onto the support plane lies within the face, edges included.
+		bool containsProjection(const gk::Point& p) const;
+		//! Get the signed distance range over the box of the specified center and half extent.
+		void distanceRange(const gk::Point& center, const gk::Vector& halfextent, float& dmin, float& dmax) const
+		{
+			float d = distance(center);
+			float r = std::fabs(_n.x) * halfextent.x + std::fabs(_n.y) * halfextent.y + std::fabs(_n.z) * halfextent.z;
 
-	private:
-
-		//! Get all connected faces.
-		void getConnectedFaces(const HEFace* face, std::unordered_map<HEFace*, HEFace*>& faceRegistry) const;
+			dmin = d - r;
+			dmax = d + r;
+		}
 	};
 
 	/************************************************************************/
@@ -120,9 +148,17 @@ private:
 	//! Iteration identifier.
 	int _iterationid;
 
-	//! Input points.
-	const gk::Point* _points;
+	//! Input points: point i's coordinates are read as a gk::Point at _points + i * _pointstride bytes,
+	//! in place for float inputs of any stride, or within _convertedpoints for double precision ones.
+	const char* _points;
+	size_t _pointstride;
 	int _pointcount;
+	std::vector<gk::Point> _convertedpoints;
+
+	//! Distance tolerance, relative to the point set's extent: points closer to a face's plane are not assigned to it.
+	float _epsilon;
+	//! Distance below which the input is classified as aligned or coplanar (negative: automatic, _epsilon).
+	float _degeneracytolerance;
 
 	//! Global vertex set.
 	std::vector<std::unique_ptr<HEVertex>> _vertices;
@@ -133,10 +169,23 @@ private:
 
 	//! Faces currently processed.
 	std::stack<HEFace*> _processingfaces;
+	//! Build failure flag: an iteration met a visible set not bordered by a single simple loop.
+	bool _failed;
 
 	//! Convex hull first vertex.
 	HEVertex* _hull;
 
+	//! Interior points retention flag.
+	bool _retaininteriors;
+	//! Removed points flags (empty if no point has been removed).
+	std::vector<char> _removed;
+	//! Number of points involved in the last hull vertex removal repair.
+	int _repairpointcount;
+
+	//! Input dimension, and its hull vertices for singular and linear inputs.
+	int _dimension;
+	std::vector<int> _degeneratehull;
+
 	//! 2D points.
 	std::vector<gk::Vec2> _points2d;
 	//! 2D convex hull internal algorithm.
@@ -144,7 +193,43 @@ private:
 
 public:
 
-	QHull3d() { clear(); }
+	//! Build phase timings, in milliseconds.
+	struct Timings
+	{
+		double vertices;		//! Internal vertices creation
+		double simplex;			//! Initial simplex creation (seed polytope or 2D fallback included)
+		double partition;		//! Initial assignment of the points to the simplex faces
+		double iterations;		//! Iterations performed by build()
+		double extraction;		//! Last hull(), mesh() or hullVertices() extraction
+	};
+
+	//! Memory held by the hull, in bytes. Containers are accounted by capacity, removed faces included.
+	struct Memory
+	{
+		size_t vertices;		//! Internal vertices
+		size_t edges;			//! Half-edges
+		size_t faces;			//! Faces
+		size_t conflicts;		//! Per-face conflict lists and retained interior points
+		size_t points;			//! Converted input points (double precision inputs)
+		size_t points2d;		//! Projected points (coplanarity case)
+		size_t scratch;			//! Processing stack and per-iteration buffers
+
+		size_t total() const { return vertices + edges + faces + conflicts + points + points2d + scratch; }
+	};
+
+private:
+
+	//! Phase timings.
+	mutable Timings _timings;
+	//! Build statistics (QHULL_STATS builds only).
+	QHullStats _stats;
+	//! Current memory, and memory at the highest total since the last initialize().
+	Memory _memory;
+	Memory _peakmemory;
+
+public:
+
+	QHull3d() : _degeneracytolerance(-1), _retaininteriors(false) { clear(); }
 	QHull3d(QHull3d&& hull) { *this = std::move(hull); }
 
 	QHull3d& operator=(QHull3d&& hull);
@@ -155,12 +240,25 @@ public:
 
 	virtual void clear();
 
-	virtual void initialize(const gk::Point* points, int count);
+	using ConvexHull3d::initialize;
+	virtual void initialize(const PointView3d& points, int count);
+	//! Initialize the hull computing for the specified point set, seeded with a previous hull's vertex indices.
+	//! Intended for temporally coherent point sets (same indexing, slightly moved positions): the seed's hull
+	//! is used as the initial polytope, and points still inside it are culled before any iteration.
+	//! Falls back to a regular initialization if the seed does not span a volume, or covers most of the points
+	//! (e.g. a sphere's): culling little, its hull would cost as much as a cold build.
+	void initialize(const PointView3d& points, int count, const std::vector<int>& seed);
 
 	virtual int build();
 	virtual bool iterate();
+	//! Returns true if the build stopped on an inconsistent horizon (degenerate input, e.g. duplicated grid points):
+	//! the surface is left closed, but does not enclose all the points. Reset by initialize().
+	bool failed() const { return _failed; }
 
 	std::vector<Face> hull() const;
+	//! Get the hull vertex indices, sorted: the face list is not materialized, each vertex being listed once off the live mesh.
+	//! Includes the hull vertices of degenerate (singular, linear or planar) inputs.
+	std::vector<int> hullVertices() const;
 
 	//! Get current hull faces' extreme vertex indices.
 	std::vector<int> getFacesExtremesIndices() const
@@ -168,7 +266,7 @@ public:
 		std::vector<int> extremeindices;
 		if (_hull)
 		{
-			std::vector<HEFace*> hullfaces = _hull->getConnectedFaces();
+			std::vector<HEFace*> hullfaces = getConnectedFaces(_hull->edge->face);
 
 			for (int i = 0; i < (int)hullfaces.size(); ++i)
 				if (!hullfaces[i]->vertices.empty())
@@ -178,15 +276,173 @@ public:
 		return extremeindices;
 	}
 
+	/************************************************************************/
+	/*							Mesh connectivity							*/
+	/************************************************************************/
+
+	//! Undirected hull edge.
+	struct Edge
+	{
+		int idx[2];		//! Vertex indices
+		int faces[2];	//! Bordering faces: faces[0] runs from idx[0] to idx[1], faces[1] from idx[1] to idx[0]
+	};
+
+	//! Hull faces with their connectivity, faces being referred to by their position in the face list.
+	struct Mesh
+	{
+		std::vector<Face> faces;			//! Faces, as returned by hull()
+		std::vector<int> neighbors;			//! Face across each face edge, 3 per face: edge k runs from idx[k] to idx[(k + 1) % 3]
+		std::vector<Edge> edges;			//! Unique undirected edges
+		std::vector<int> vertices;			//! Hull vertex indices
+		std::vector<int> fanoffsets;		//! Vertex fans: the faces around vertices[v], counter clockwise seen from outside,
+		std::vector<int> fanfaces;			//! are fanfaces[fanoffsets[v]] to fanfaces[fanoffsets[v + 1] - 1]
+	};
+
+	//! Get the hull faces with their adjacency, edge list and vertex fans, read off the half-edge structure in one pass.
+	//! Empty for the 2D fallback, whose polygon has no half-edge structure.
+	Mesh mesh() const;
+
+	/************************************************************************/
+	/*							Degenerate inputs							*/
+	/************************************************************************/
+
+	//! Input dimensions.
+	enum Dimension
+	{
+		Empty = -1,		//! No point
+		Singular,		//! All the points within the tolerance of a single one
+		Linear,			//! All the points within the tolerance of a line: the hull is a segment
+		Planar,			//! All the points within the tolerance of a plane: the hull is computed by the 2D engine
+		Volumetric		//! Regular 3D hull
+	};
+
+	//! Set the distance below which the input is classified as singular, linear or planar. Must be set before initialize().
+	//! A negative tolerance selects the automatic one, the rounding error bound of the distance computations.
+	void setDegeneracyTolerance(float tolerance) { _degeneracytolerance = tolerance; }
+	float degeneracyTolerance() const { return _degeneracytolerance; }
+
+	//! Get the input dimension, as classified by the last initialize().
+	Dimension dimension() const { return (Dimension)_dimension; }
+	//! Get the hull vertex indices of a singular (one point) or linear (segment endpoints) input, empty otherwise.
+	const std::vector<int>& degenerateHull() const { return _degeneratehull; }
+
+	/************************************************************************/
+	/*							Point removal								*/
+	/************************************************************************/
+
+	//! Enable or disable the retention of interior points, bucketed per face.
+	//! Must be set before initialize(). Required by removePoint().
+	void setRetainInteriorPoints(bool retain) { _retaininteriors = retain; }
+	bool retainInteriorPoints() const { return _retaininteriors; }
+
+	//! Remove the specified point from the hull's point set.
+	//! Removing an interior point is performed in constant time. Removing a hull vertex
+	//! rebuilds the cavity left by its incident faces from their retained interior points.
+	//! Requires interior points retention and a complete 3D hull.
+	//! Returns false if the point could not be removed.
+	bool removePoint(int index);
+	//! Returns true if the specified point has been removed.
+	bool isRemoved(int index) const { return !_removed.empty() && _removed[index]; }
+
+	//! Get the number of points involved in the last hull vertex removal repair.
+	int lastRepairPointCount() const { return _repairpointcount; }
+
+	/************************************************************************/
+	/*							Kinetic update								*/
+	/************************************************************************/
+
+	//! Update the hull after a small motion of the points (same point count and indexing).
+	//! Face planes are re-evaluated, reflex edges are flipped, hull vertices sunk into the hull are demoted to
+	//! interior points, and retained interior points escaping through their face's neighborhood are extruded.
+	//! Requires interior points retention and a complete 3D hull, falls back to a full rebuild otherwise.
+	//! Returns the number of performed repairs, or -1 if the hull has been fully rebuilt.
+	int update(const PointView3d& points);
+
+	/************************************************************************/
+	/*								Profiling								*/
+	/************************************************************************/
+
+	//! Get the phase timings of the last initialize(), build() and hull() calls.
+	const Timings& timings() const { return _timings; }
+	//! Get the statistics accumulated since the last initialize() (left null unless QHULL_STATS is defined).
+	const QHullStats& stats() const { return _stats; }
+	//! Get the memory currently held, as of the last initialize(), iterate(), removePoint() or update() call.
+	const Memory& memory() const { return _memory; }
+	//! Get the memory held when its total was the highest since the last initialize().
+	const Memory& peakMemory() const { return _peakmemory; }
+
 private:
 
-	//! Build internal vertices from input points.
+	//! Get the elapsed time since the specified time point, in milliseconds.
+	static double elapsed(const std::chrono::steady_clock::time_point& start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	//! Update the memory accounting from the containers' capacities and the specified scratch bytes, and track the peak.
+	//! Conflict storage is accounted incrementally by iterate(), or recounted by countConflictMemory().
+	void updateMemory(size_t scratch);
+	//! Recount the conflict storage held by all the faces.
+	void countConflictMemory();
+	//! Get the conflict storage held by the specified face.
+	static size_t conflictMemory(const HEFace* face)
+	{
+		return (face->vertices.capacity() + face->interiors.capacity()) * sizeof(HEVertex*);
+	}
+
+	//! Get the specified input point.
+	const gk::Point& point(int i) const { return *(const gk::Point*)(_points + i * _pointstride); }
+	//! Set the input points up: float ones are read in place, double precision ones are converted.
+	void setPoints(const PointView3d& points, int count);
+
+	//! Build internal vertices from input points, and compute the distance tolerance.
 	void createVertices();
-	//! Build initial tetrahedron.
+	//! Build initial tetrahedron, or classify the input as degenerate and set its dedicated hull up.
 	void createInitialTetrahedron();
-
-	//! Initialize the internal 2D convex hull computing (coplanarity case).
-	void initialize2d();
+	//! Record the simplex creation phase of a degenerate input.
+	void finishDegenerateSimplex(const std::chrono::steady_clock::time_point& start);
+
+	//! Build the initial polytope as the seed vertices' hull, iterated in place, then assign the remaining points.
+	//! Returns false if the seed vertices cover most of the points, do not span a volume or their hull failed
+	//! (the mesh being left to clear if started).
+	bool createSeedPolytope(const std::vector<int>& seed);
+	//! Pick the seed's initial tetrahedron, as createInitialTetrahedron() does over all the points.
+	//! Returns false if the seed vertices do not span a volume.
+	bool findSeedTetrahedron(const std::vector<int>& seed, int tetraidx[4]) const;
+	//! Walk from the specified face to the face whose cone, apexed at the specified inner point, contains p.
+	//! Faces are marked with the walk's identifier into walks (indexed by face identifier), each being crossed once.
+	//! Returns nullptr if the walk cycles back to a crossed face.
+	HEFace* locateFace(HEFace* face, const gk::Point& center, const gk::Point& p, int walk, std::vector<int>& walks) const;
+
+	//! Initialize the internal 2D convex hull computing (coplanarity case), in the plane of the specified points.
+	void initialize2d(int p0idx, int p1idx, int p2idx);
+
+	//! Rebuild the whole hull from the non removed points.
+	void rebuild();
+
+	//! Assign the specified vertices to the first of the specified faces they are visible from, retaining the others in retention mode.
+	//! Vertices are tested by buckets of consecutive ones: a face the bucket's bounding box lies behind is skipped for the whole bucket,
+	//! and a face the box lies in front of takes the whole bucket.
+	void assignVertices(HEVertex* const* vertices, int count, const std::vector<HEFace*>& faces);
+	//! Retain the specified vertex as an interior point of the closest specified face.
+	void retainVertex(const std::vector<HEFace*>& faces, HEVertex* v);
+	//! Rebuild the hull's surface around the specified vertex, excluding it.
+	//! The vertex is retained as an interior point if demoted, dropped otherwise.
+	//! The removed faces are detached (null edge), and the created ones are returned into capfaces.
+	//! Returns false if the cavity could not be locally repaired.
+	bool repairCavity(HEVertex* vertex, bool demote, std::vector<HEFace*>& capfaces);
+	//! Select the cap closing a cavity: the faces of the specified cavity points' hull enclosed by the cavity's border loop,
+	//! its loopsize vertices being the first candidates, in loop order. Returns false if the loop does not border the cavity hull.
+	bool selectCap(const std::vector<HEVertex*>& candidates, long long loopsize, std::vector<Face>& cap) const;
+
+	//! Returns true if the edge shared by the specified half-edge's faces is reflex.
+	bool isReflex(const HEEdge* edge, float epsilon) const;
+	//! Returns true if the specified closed surface is convex: no reflex edge, and all the faces oriented away
+	//! from its faces' mean centroid, returned into center.
+	bool isConvexSurface(const std::vector<HEFace*>& faces, float epsilon, gk::Point& center) const;
+	//! Flip the edge shared by the specified half-edge's faces.
+	//! Returns false if the flipped edge would not be convex or would break the manifold.
+	bool flipEdge(HEEdge* edge, float epsilon);
 
 	//! Create a new managed edge.
 	HEEdge* createEdge();
@@ -196,6 +452,10 @@ private:
 	//! Vertices are assumed to be specified in counter clockwise order according to the underlying surface.
 	HEFace* createFace(int v1idx, int v2idx, int v3idx);
 
+	//! Create new managed faces from the specified indexed triangles, indices referring to the specified vertex list.
+	//! Shared edges are sewn together, and open edges to the matching border edges (keyed by <from, to> vertex indices).
+	std::vector<HEFace*> createMesh(const std::vector<Face>& faces, const std::vector<HEVertex*>& vertices, const std::unordered_map<long long, HEEdge*>& borders);
+
 	//! Create new faces (fan configuration) by extruding the specified edge loop toward the specified vertex.
 	//! The target vertex is assumed to be in the specified edge loop's positive half-space.
 	//! The specified edge loop is assumed to be valid and counter clockwise oriented.
@@ -208,23 +468,37 @@ private:
 	//! The specified edge loop is assumed to be valid and counter clockwise oriented.
 	std::vector<HEFace*> extrudeOut(const std::vector<HEEdge*>& loop, int vidx);
 
+	//! Visit all the faces connected to the specified face, depth first.
+	template <typename Visitor>
+	void visitConnectedFaces(const HEFace* face, Visitor visit) const;
+	//! Get all the faces connected to the specified face.
+	std::vector<HEFace*> getConnectedFaces(const HEFace* face) const;
+
 	//! Get all unvisited faces connected to the specified faces, visible by the specified vertex.
 	//! A face is considered unvisited if its iteration identifier does not match the specified one.
 	void getVisibleUnvisitedConnectedFaces(const int iterationId, const HEFace* face, const gk::Point& p, std::vector<HEFace*>& visiblefaces);
+	//! Add to the specified visible face set the hidden regions it encloses, all but the largest region bordering it.
+	//! Returns false if the visible set has a single border.
+	bool fillVisibleHoles(const int iterationId, std::vector<HEFace*>& visiblefaces);
 	//! Get the horizon edge loop within the specified visible face set.
 	//! The obtained horizon edge loop is counter clockwise oriented.
 	//! Returns an empty vector and sets onedge to true if the point is on an horizon edge.
+	//! Returns an empty vector with onedge false if the visible set is not bordered by a single simple loop.
 	std::vector<HEEdge*> getHorizonEdgeLoop(const int iterationId, const std::vector<HEFace*>& visiblefaces, const gk::Point& p, bool& onedge) const;
 	//! Get the horizon edge directly following the specified one in the counter clockwise direction.
-	HEEdge* getNextHorizonEdge(const int iterationId, HEEdge* horizonedge) const;
+	//! Returns nullptr if no visible face is found within the specified number of turning steps.
+	HEEdge* getNextHorizonEdge(const int iterationId, HEEdge* horizonedge, int maxsteps) const;
 	//! Returns true if the point p is on the segment formed by e1 and e2.
 	bool isOnEdge(const gk::Point& e1, const gk::Point& e2, const gk::Point& p) const;
+	//! Returns true if the point p, assumed coplanar with the specified half-edge's co-face, lies on the co-face's side
+	//! of the edge or within the distance tolerance of its support line: the edge's extrusion to p would be folded or flat.
+	bool isFoldingEdge(const HEEdge* edge, const gk::Point& p) const;
 
 	//! Check the specified manifold validity (debug purpose only).
 	void assertManifoldValidity(const HEVertex* vertex) const
 	{
 		// Get all connected faces
-		std::vector<QHull3d::HEFace*> mesh = vertex->getConnectedFaces();
+		std::vector<QHull3d::HEFace*> mesh = getConnectedFaces(vertex->edge->face);
 
 		for (int f = 0; f < (int)mesh.size(); ++f)
 		{
@@ -249,11 +523,6 @@ private:
 	}
 };
 
-inline std::vector<QHull3d::HEFace*> QHull3d::HEVertex::getConnectedFaces() const
-{
-	return edge->face->getConnectedFaces();
-}
-
 inline void QHull3d::HEFace::reverse()
 {
 	HEEdge* edge3 = edge;
@@ -291,15 +560,15 @@ inline void QHull3d::HEFace::updateSupportPlane()
 	_d = -(v1.x * _n.x + v1.y * _n.y + v1.z * _n.z);
 }
 
-inline bool QHull3d::HEFace::tryAssignVertex(QHull3d::HEVertex* v)
+inline bool QHull3d::HEFace::tryAssignVertex(QHull3d::HEVertex* v, float epsilon)
 {
 	float d;
 
-	if ((d = distance(v->getPoint())) < 0)
+	if ((d = distance(v->getPoint())) <= epsilon)
 		return false;
 
 	//if (d > _extremedistance)
-	if (d >= _extremedistance)
+	if (vertices.empty() || d >= _extremedistance)
 	{
 		vertices.insert(vertices.begin(), v);
 
@@ -313,6 +582,42 @@ inline bool QHull3d::HEFace::tryAssignVertex(QHull3d::HEVertex* v)
 	return true;
 }
 
+inline void QHull3d::HEFace::retainVertex(QHull3d::HEVertex* v)
+{
+	v->bucket = this;
+	v->bucketslot = (int)interiors.size();
+
+	interiors.push_back(v);
+}
+inline void QHull3d::HEFace::releaseVertex(QHull3d::HEVertex* v)
+{
+	std::vector<HEVertex*>& interiors = v->bucket->interiors;
+
+	// Swap with the last retained vertex
+	HEVertex* last = interiors.back();
+
+	interiors[v->bucketslot] = last;
+	last->bucketslot = v->bucketslot;
+
+	interiors.pop_back();
+
+	v->bucket = nullptr;
+	v->bucketslot = -1;
+}
+
+inline bool QHull3d::HEFace::containsProjection(const gk::Point& p) const
+{
+	const HEEdge* e = edge;
+	for (int i = 0; i < 3; ++i, e = e->next)
+	{
+		const gk::Point& a = e->next->next->vertex->getPoint();
+		if (gk::Dot(gk::Cross(gk::Vector(a, e->vertex->getPoint()), gk::Vector(a, p)), _n) < 0)
+			return false;
+	}
+
+	return true;
+}
+
 inline std::vector<QHull3d::HEVertex*> QHull3d::HEFace::getBorderingVertices() const
 {
 	std::vector<QHull3d::HEVertex*> vertices;
@@ -337,29 +642,40 @@ inline std::vector<QHull3d::HEFace*> QHull3d::HEFace::getAdjacentFaces() const
 
 	return adjacentfaces;
 }
-inline std::vector<QHull3d::HEFace*> QHull3d::HEFace::getConnectedFaces() const
+template <typename Visitor>
+inline void QHull3d::visitConnectedFaces(const HEFace* face, Visitor visit) const
 {
-	std::vector<HEFace*> connectedfaces;
-	std::unordered_map<HEFace*, HEFace*> faceregistry;
+	// Depth first traversal with an explicit stack (large hulls would overflow the call stack), faces being marked by slot
+	std::vector<char> visited(_faces.size(), 0);
+	std::vector<HEFace*> stack(1, (HEFace*)face);
 
-	getConnectedFaces(this, faceregistry);
+	visited[face->id] = 1;
 
-	connectedfaces.reserve(faceregistry.size());
-	for (auto it = faceregistry.begin(); it != faceregistry.end(); ++it)
-		connectedfaces.push_back(it->second);
+	while (!stack.empty())
+	{
+		HEFace* f = stack.back();
+		stack.pop_back();
 
-	return connectedfaces;
+		visit(f);
+
+		HEEdge* edge = f->edge;
+		for (int e = 0; e < 3; ++e, edge = edge->next)
+		{
+			if (edge->coedge && !visited[edge->coedge->face->id])
+			{
+				visited[edge->coedge->face->id] = 1;
+				stack.push_back(edge->coedge->face);
+			}
+		}
+	}
 }
-inline void QHull3d::HEFace::getConnectedFaces(const QHull3d::HEFace* face, std::unordered_map<QHull3d::HEFace*, QHull3d::HEFace*>& faceRegistry) const
+inline std::vector<QHull3d::HEFace*> QHull3d::getConnectedFaces(const HEFace* face) const
 {
-	if (faceRegistry.count((HEFace*)face))
-		return;
+	std::vector<HEFace*> connectedfaces;
 
-	faceRegistry[(HEFace*)face] = (HEFace*)face;
+	visitConnectedFaces(face, [&](HEFace* f) { connectedfaces.push_back(f); });
 
-	std::vector<HEFace*> adjacentfaces = face->getAdjacentFaces();
-	for (int i = 0; i < (int)adjacentfaces.size(); ++i)
-		getConnectedFaces(adjacentfaces[i], faceRegistry);
+	return connectedfaces;
 }
 
 inline QHull3d& QHull3d::operator=(QHull3d&& hull)
@@ -369,16 +685,33 @@ inline QHull3d& QHull3d::operator=(QHull3d&& hull)
 		_iterationid = hull._iterationid;
 
 		_points = hull._points;
+		_pointstride = hull._pointstride;
 		_pointcount = hull._pointcount;
+		_convertedpoints = std::move(hull._convertedpoints);
+		_epsilon = hull._epsilon;
+		_degeneracytolerance = hull._degeneracytolerance;
 
 		_vertices = std::move(hull._vertices);
 		_edges = std::move(hull._edges);
 		_faces = std::move(hull._faces);
 		_processingfaces = std::move(hull._processingfaces);
+		_failed = hull._failed;
 		_hull = std::move(hull._hull);
 
+		_retaininteriors = hull._retaininteriors;
+		_removed = std::move(hull._removed);
+		_repairpointcount = hull._repairpointcount;
+
+		_dimension = hull._dimension;
+		_degeneratehull = std::move(hull._degeneratehull);
+
 		_points2d = std::move(hull._points2d);
 		_hull2d = std::move(hull._hull2d);
+
+		_timings = hull._timings;
+		_stats = hull._stats;
+		_memory = hull._memory;
+		_peakmemory = hull._peakmemory;
 	}
 
 	return *this;
@@ -389,9 +722,16 @@ inline void QHull3d::clear()
 	_hull2d.reset();
 	_points2d.clear();
 
+	_dimension = Empty;
+	_degeneratehull.clear();
+
+	_removed.clear();
+	_repairpointcount = 0;
+
 	_hull = nullptr;
 	while (!_processingfaces.empty())
 		_processingfaces.pop();
+	_failed = false;
 
 	_faces.clear();
 	_edges.clear();
@@ -400,15 +740,22 @@ inline void QHull3d::clear()
 	_iterationid = -1;
 
 	_points = nullptr;
+	_pointstride = sizeof(gk::Point);
 	_pointcount = 0;
+	_convertedpoints.clear();
+	_epsilon = 0;
+
+	_timings = Timings();
+	_stats.clear();
+	_memory = Memory();
+	_peakmemory = Memory();
 }
 
 inline QHull3d::HEEdge* QHull3d::createEdge()
 {
 	HEEdge* edge = new HEEdge();
 
-	static int edgeid = 1;
-	edge->id = edgeid++;
+	edge->id = (int)_edges.size();
 
 	_edges.push_back(std::unique_ptr<HEEdge>(edge));
 
@@ -418,8 +765,9 @@ inline QHull3d::HEFace* QHull3d::createFace()
 {
 	HEFace* face = new HEFace();
 
-	static int faceid = 1;
-	face->id = faceid++;
+	face->id = (int)_faces.size();
+
+	QHULL_STAT(++_stats.createdfaces);
 
 	_faces.push_back(std::unique_ptr<HEFace>(face));
 
@@ -501,6 +849,7 @@ inline std::vector<QHull3d::HEFace*> QHull3d::extrudeIn(const std::vector<QHull3
 
 		if (!v3->edge)
 			v3->edge = edge2;
+		v2->edge = edge1;
 
 		face->edge = edge3;
 
@@ -607,13 +956,42 @@ inline std::vector<QHull3d::HEFace*> QHull3d::extrudeOut(const std::vector<QHull
 
 inline int QHull3d::build()
 {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	int iterations;
+
 	// Coplanarity case
 	if (_hull2d)
-		return _hull2d->build();
+	{
+		QHULL_TRACE("build2d");
+
+		iterations = _hull2d->build();
+	}
+	else if (!QHullTrace::isEnabled())
+	{
+		while (iterate());
 
-	while (iterate());
+		iterations = _iterationid + 1;
+	}
+	else
+	{
+		// Trace the iterations by batches
+		bool iterating = true;
+		while (iterating)
+		{
+			std::chrono::steady_clock::time_point batchstart = std::chrono::steady_clock::now();
+			int first = _iterationid + 1;
+
+			for (int i = 0; i < QHULL_TRACE_ITERATION_BATCH && (iterating = iterate()); ++i);
+
+			QHullTrace::complete("iterations", batchstart, "first", first);
+		}
+
+		iterations = _iterationid + 1;
+	}
 
-	return _iterationid + 1;
+	_timings.iterations = elapsed(start);
+
+	return iterations;
 }
 inline bool QHull3d::iterate()
 {
@@ -623,6 +1001,9 @@ inline bool QHull3d::iterate()
 	if (_hull2d)
 		return _hull2d->iterate();
 
+	if (_failed)
+		return false;
+
 	face = nullptr;
 
 	// Get the next non-empty face to process
@@ -648,65 +1029,498 @@ inline bool QHull3d::iterate()
 	// Get all unvisited connected faces visible from the current face's extreme point
 	getVisibleUnvisitedConnectedFaces(_iterationid, visiblefaces[0], extreme->getPoint(), visiblefaces);
 
+	QHULL_STAT(++_stats.iterations);
+
 	// Get horizon edges within the visible face set
 	bool onedge;
 	std::vector<QHull3d::HEEdge*> horizoneedgeloop = getHorizonEdgeLoop(_iterationid, visiblefaces, extreme->getPoint(), onedge);
 
+	// Faces the point lies slightly behind, surrounded by visible faces (nearly coplanar, rounded off): swallow them
+	if (horizoneedgeloop.empty() && !onedge && fillVisibleHoles(_iterationid, visiblefaces))
+		horizoneedgeloop = getHorizonEdgeLoop(_iterationid, visiblefaces, extreme->getPoint(), onedge);
+
 	// Discard points on edge
 	if (onedge)
+	{
+		QHULL_STAT(++_stats.onedgepoints);
+
+		if (_retaininteriors)
+		{
+			_memory.conflicts -= conflictMemory(face);
+			face->retainVertex(extreme);
+			_memory.conflicts += conflictMemory(face);
+		}
+
 		return true;
+	}
+
+	// Inconsistent horizon: stop before modifying the mesh, the extreme point being put back
+	if (horizoneedgeloop.empty())
+	{
+		face->vertices.insert(face->vertices.begin(), extreme);
+		_processingfaces.push(face);
+
+		_failed = true;
+
+		return false;
+	}
+
+	QHULL_STAT(_stats.visiblefaces += visiblefaces.size());
+	QHULL_STAT(_stats.visiblefaceshistogram.add(visiblefaces.size()));
+	QHULL_STAT(_stats.horizonedges += horizoneedgeloop.size());
+	QHULL_STAT(_stats.horizonedgeshistogram.add(horizoneedgeloop.size()));
 
 	// Extrude the horizon to the extreme point
 	std::vector<HEFace*> newfaces = extrudeIn(horizoneedgeloop, extreme->index);
 
+	QHULL_STAT(long long reassigned = 0);
+
 	// Assign the old visible faces remaining points to the new faces
 	for (int of = 0; of < (int)visiblefaces.size(); ++of)
 	{
 		HEFace* oldface = visiblefaces[of];
 
-		for (int v = 0; v < (int)oldface->vertices.size(); ++v)
+		QHULL_STAT(reassigned += oldface->vertices.size());
+		_memory.conflicts -= conflictMemory(oldface);
+
+		if (!oldface->vertices.empty())
+			assignVertices(&oldface->vertices[0], (int)oldface->vertices.size(), newfaces);
+
+		// Release the removed face's storage
+		std::vector<HEVertex*>().swap(oldface->vertices);
+
+		// Move retained interior points to the new faces
+		for (int v = 0; v < (int)oldface->interiors.size(); ++v)
+			retainVertex(newfaces, oldface->interiors[v]);
+
+		std::vector<HEVertex*>().swap(oldface->interiors);
+	}
+
+	QHULL_STAT(_stats.reassignedpoints += reassigned);
+	QHULL_STAT(_stats.reassignedhistogram.add(reassigned));
+	QHULL_STAT(_stats.deletedfaces += visiblefaces.size());
+
+	// Detach the vertices swallowed by the extrusion (horizon vertices now emanate new edges)
+	for (int of = 0; of < (int)visiblefaces.size(); ++of)
+	{
+		HEEdge* edge = visiblefaces[of]->edge;
+		for (int e = 0; e < 3; ++e, edge = edge->next)
 		{
-			HEVertex* vertex = oldface->vertices[v];
-			for (int nf = 0; nf < (int)newfaces.size(); ++nf)
-				if (newfaces[nf]->tryAssignVertex(vertex))
-					break;
-		}
+			HEVertex* vertex = edge->vertex;
+
+			if (vertex->edge && vertex->edge->face->iterationid == _iterationid)
+			{
+				vertex->edge = nullptr;
 
-		oldface->vertices.clear();
+				if (_retaininteriors)
+					retainVertex(newfaces, vertex);
+			}
+		}
 	}
 
 	// Push the new created faces on the processing stack
 	for (int i = 0; i < (int)newfaces.size(); ++i)
+	{
 		_processingfaces.push(newfaces[i]);
+		_memory.conflicts += conflictMemory(newfaces[i]);
+	}
 
 	// Update hull starting vertex
 	_hull = extreme;
 
+	updateMemory((visiblefaces.capacity() + newfaces.capacity()) * sizeof(HEFace*) + horizoneedgeloop.capacity() * sizeof(HEEdge*));
+
 	//////////////////////////////////////////////////////////////////////////
 	// ToDo JRA: Remove this test code
 
+#ifdef _DEBUG
 	assertManifoldValidity(_hull);
+#endif
 
 	return true;
 }
 
+inline void QHull3d::updateMemory(size_t scratch)
+{
+	_memory.vertices = _vertices.capacity() * sizeof(std::unique_ptr<HEVertex>) + _vertices.size() * sizeof(HEVertex);
+	_memory.edges = _edges.capacity() * sizeof(std::unique_ptr<HEEdge>) + _edges.size() * sizeof(HEEdge);
+	_memory.faces = _faces.capacity() * sizeof(std::unique_ptr<HEFace>) + _faces.size() * sizeof(HEFace);
+	_memory.points = _convertedpoints.capacity() * sizeof(gk::Point);
+	_memory.points2d = _points2d.capacity() * sizeof(gk::Vec2);
+	_memory.scratch = _processingfaces.size() * sizeof(HEFace*) + scratch;
+
+	if (_memory.total() > _peakmemory.total())
+		_peakmemory = _memory;
+}
+
+inline void QHull3d::assignVertices(HEVertex* const* vertices, int count, const std::vector<HEFace*>& faces)
+{
+	for (int first = 0; first < count; first += QHULL_CONFLICT_BUCKET_SIZE)
+	{
+		int last = std::min(first + QHULL_CONFLICT_BUCKET_SIZE, count);
+
+		// Skip the faces the bucket's box lies behind, up to the first one it is not entirely behind
+		// (with an epsilon margin both ways, covering the box distances' rounding)
+		int f = 0;
+		bool infront = false;
+
+		if (last - first >= QHULL_CONFLICT_BUCKET_MIN)
+		{
+			gk::Point pmin = vertices[first]->getPoint();
+			gk::Point pmax = pmin;
+
+			for (int v = first + 1; v < last; ++v)
+			{
+				const gk::Point& p = vertices[v]->getPoint();
+
+				pmin.x = std::min(pmin.x, p.x);
+				pmin.y = std::min(pmin.y, p.y);
+				pmin.z = std::min(pmin.z, p.z);
+				pmax.x = std::max(pmax.x, p.x);
+				pmax.y = std::max(pmax.y, p.y);
+				pmax.z = std::max(pmax.z, p.z);
+			}
+
+			gk::Point center((pmin.x + pmax.x) * 0.5f, (pmin.y + pmax.y) * 0.5f, (pmin.z + pmax.z) * 0.5f);
+			gk::Vector halfextent((pmax.x - pmin.x) * 0.5f, (pmax.y - pmin.y) * 0.5f, (pmax.z - pmin.z) * 0.5f);
+
+			for (; f < (int)faces.size(); ++f)
+			{
+				float dmin, dmax;
+				faces[f]->distanceRange(center, halfextent, dmin, dmax);
+
+				QHULL_STAT(++_stats.buckettests);
+
+				if (dmax > -_epsilon)
+				{
+					infront = dmin > 3 * _epsilon;
+					break;
+				}
+			}
+		}
+
+		// Behind all the faces: interior bucket
+		if (f == (int)faces.size())
+		{
+			QHULL_STAT(_stats.bucketresolved += last - first);
+
+			if (_retaininteriors)
+				for (int v = first; v < last; ++v)
+					retainVertex(faces, vertices[v]);
+
+			continue;
+		}
+
+		// In front of the face: the whole bucket is visible from it
+		if (infront)
+		{
+			QHULL_STAT(_stats.bucketresolved += last - first);
+
+			for (int v = first; v < last; ++v)
+				faces[f]->tryAssignVertex(vertices[v], _epsilon);
+
+			continue;
+		}
+
+		// Straddling the face: test each vertex from that face on
+		for (int v = first; v < last; ++v)
+		{
+			int vf;
+			for (vf = f; vf < (int)faces.size(); ++vf)
+			{
+				QHULL_STAT(++_stats.distancetests);
+
+				if (faces[vf]->tryAssignVertex(vertices[v], _epsilon))
+					break;
+			}
+
+			if (vf == (int)faces.size() && _retaininteriors)
+				retainVertex(faces, vertices[v]);
+		}
+	}
+}
+inline void QHull3d::retainVertex(const std::vector<HEFace*>& faces, HEVertex* v)
+{
+	// Retain into the face whose support plane is the closest
+	const gk::Point& p = v->getPoint();
+	HEFace* closest = faces[0];
+	float dmax = closest->distance(p);
+	float dnext = -HUGE_VALF;
+
+	for (int f = 1; f < (int)faces.size(); ++f)
+	{
+		float d = faces[f]->distance(p);
+		if (d > dmax)
+		{
+			closest = faces[f];
+			dnext = dmax;
+			dmax = d;
+		}
+		else
+			dnext = std::max(dnext, d);
+	}
+
+	// Ties (coplanar faces) go to the face the point projects into, removing a hull vertex gathering the points retained around it
+	if (dnext >= dmax - _epsilon && !closest->containsProjection(p))
+	{
+		for (int f = 0; f < (int)faces.size(); ++f)
+		{
+			if (faces[f] != closest && faces[f]->distance(p) >= dmax - _epsilon && faces[f]->containsProjection(p))
+			{
+				closest = faces[f];
+				break;
+			}
+		}
+	}
+
+	closest->retainVertex(v);
+}
+
+inline bool QHull3d::isReflex(const HEEdge* edge, float epsilon) const
+{
+	// The co-face's apex is above the face's support plane
+	return edge->face->distance(edge->coedge->next->vertex->getPoint()) > epsilon;
+}
+inline bool QHull3d::flipEdge(HEEdge* edge, float epsilon)
+{
+	// Faces <X, Y, W> and <Y, X, Z> become <Z, Y, W> and <W, X, Z>
+	HEEdge* a1 = edge->next;
+	HEEdge* a2 = a1->next;
+	HEEdge* coedge = edge->coedge;
+	HEEdge* b1 = coedge->next;
+	HEEdge* b2 = b1->next;
+
+	HEFace* fa = edge->face;
+	HEFace* fb = coedge->face;
+
+	HEVertex* x = a2->vertex;
+	HEVertex* y = edge->vertex;
+	HEVertex* w = a1->vertex;
+	HEVertex* z = b1->vertex;
+
+	// The apexes must not be already connected
+	HEEdge* e = w->edge;
+	do
+	{
+		if (e->vertex == z)
+			return false;
+
+		e = e->next->next->coedge;
+	} while (e != w->edge);
+
+	// The flipped edge must be convex
+	const gk::Point& px = x->getPoint();
+	const gk::Point& py = y->getPoint();
+	const gk::Point& pw = w->getPoint();
+	const gk::Point& pz = z->getPoint();
+
+	gk::Vector na = gk::Cross(gk::Vector(pz, py), gk::Vector(pz, pw));
+	gk::Vector nb = gk::Cross(gk::Vector(pw, px), gk::Vector(pw, pz));
+
+	if (na.LengthSquared() == 0 || nb.LengthSquared() == 0)
+		return false;
+	if (gk::Dot(gk::Normalize(na), gk::Vector(pz, px)) > epsilon || gk::Dot(gk::Normalize(nb), gk::Vector(pw, py)) > epsilon)
+		return false;
+
+	// Rewire the half-edges
+	edge->vertex = z;
+	edge->next = b2;
+	b2->next = a1;
+	a1->next = edge;
+	b2->face = fa;
+
+	coedge->vertex = w;
+	coedge->next = a2;
+	a2->next = b1;
+	b1->next = coedge;
+	a2->face = fb;
+
+	fa->edge = edge;
+	fb->edge = coedge;
+
+	x->edge = b1;
+	y->edge = a1;
+	w->edge = a2;
+	z->edge = b2;
+
+	fa->updateSupportPlane();
+	fb->updateSupportPlane();
+
+	// Redistribute the retained interior points
+	if (!fa->interiors.empty() || !fb->interiors.empty())
+	{
+		std::vector<HEVertex*> interiors = fa->interiors;
+		interiors.insert(interiors.end(), fb->interiors.begin(), fb->interiors.end());
+
+		fa->interiors.clear();
+		fb->interiors.clear();
+
+		for (int i = 0; i < (int)interiors.size(); ++i)
+			retainVertex({ fa, fb }, interiors[i]);
+	}
+
+	return true;
+}
+
+inline QHull3d::HEFace* QHull3d::locateFace(HEFace* face, const gk::Point& center, const gk::Point& p, int walk, std::vector<int>& walks) const
+{
+	gk::Vector cp(center, p);
+	HEEdge* entry = nullptr;
+
+	while (walks[face->id] != walk)
+	{
+		walks[face->id] = walk;
+
+		HEEdge* exit = nullptr;
+
+		// Leave through the first edge whose <center, edge> plane separates the face from the point,
+		// the entry edge being known not to
+		HEEdge* edge = face->edge;
+		for (int i = 0; i < 3; ++i, edge = edge->next)
+		{
+			if (edge->next == entry)
+				continue;
+
+			gk::Vector ca(center, edge->vertex->getPoint());
+			gk::Vector cb(center, edge->next->vertex->getPoint());
+
+			if (gk::Dot(gk::Cross(ca, cb), cp) < 0)
+			{
+				exit = edge->next;
+				break;
+			}
+		}
+
+		if (!exit)
+			return face;
+
+		entry = exit->coedge;
+		face = entry->face;
+	}
+
+	return nullptr;
+}
+
 inline void QHull3d::getVisibleUnvisitedConnectedFaces(const int iterationId, const HEFace* face, const gk::Point& p, std::vector<HEFace*>& visiblefaces)
 {
-	std::vector<HEFace*> adjacentfaces = face->getAdjacentFaces();
+	// Depth first traversal with an explicit stack of (face, next adjacent face) pairs, in recursion order
+	std::vector<std::pair<const HEFace*, int>> stack(1, std::make_pair(face, 0));
 
-	for (int i = 0; i < (int)adjacentfaces.size(); ++i)
+	while (!stack.empty())
 	{
-		HEFace* adjacentface = adjacentfaces[i];
+		const HEFace* current = stack.back().first;
+		int i = stack.back().second++;
 
-		//if (adjacentface->iterationid != iterationId && adjacentface->distance(p) > 0)
-		if (adjacentface->iterationid != iterationId && adjacentface->distance(p) >= 0)
+		if (i == 3)
+		{
+			stack.pop_back();
+			continue;
+		}
+
+		const HEEdge* edge = current->edge;
+		while (i-- > 0)
+			edge = edge->next;
+
+		if (!edge->coedge)
+			continue;
+
+		HEFace* adjacentface = edge->coedge->face;
+
+		if (adjacentface->iterationid == iterationId)
+			continue;
+
+		QHULL_STAT(++_stats.distancetests);
+
+		// Faces the point lies slightly behind (coplanar, rounded off, on grid inputs) are visible too
+		// when extruding the shared edge to the point would fold the new face over them
+		//if (adjacentface->distance(p) > 0)
+		float d = adjacentface->distance(p);
+		if (d >= 0 || (d >= -_epsilon && isFoldingEdge(edge, p)))
 		{
 			adjacentface->iterationid = iterationId;
 			visiblefaces.push_back(adjacentface);
 
-			getVisibleUnvisitedConnectedFaces(iterationId, adjacentface, p, visiblefaces);
+			stack.push_back(std::make_pair(adjacentface, 0));
+		}
+	}
+}
+inline bool QHull3d::fillVisibleHoles(const int iterationId, std::vector<HEFace*>& visiblefaces)
+{
+	// Flood the hidden regions from the horizon edges, the region r being marked -2 - r.
+	// A region outgrowing the visible set is the outer hull: its flood stops there.
+	const int maxfaces = (int)visiblefaces.size();
+
+	std::vector<std::vector<HEFace*>> regions;
+	std::vector<bool> bounded;
+
+	for (int f = 0; f < maxfaces; ++f)
+	{
+		HEEdge* edge = visiblefaces[f]->edge;
+		for (int i = 0; i < 3; ++i, edge = edge->next)
+		{
+			HEFace* start = edge->coedge->face;
+
+			if (start->iterationid == iterationId || start->iterationid <= -2)
+				continue;
+
+			int regionid = -2 - (int)regions.size();
+			regions.push_back(std::vector<HEFace*>(1, start));
+			start->iterationid = regionid;
+
+			std::vector<HEFace*>& region = regions.back();
+			bounded.push_back(true);
+
+			for (int r = 0; r < (int)region.size() && bounded.back(); ++r)
+			{
+				HEEdge* regionedge = region[r]->edge;
+				for (int j = 0; j < 3; ++j, regionedge = regionedge->next)
+				{
+					HEFace* adjacentface = regionedge->coedge->face;
+
+					if (adjacentface->iterationid == iterationId || adjacentface->iterationid == regionid)
+						continue;
+
+					// Reaching a stopped flood: same region
+					if (adjacentface->iterationid <= -2 || (int)region.size() == maxfaces)
+					{
+						bounded.back() = false;
+						break;
+					}
+
+					adjacentface->iterationid = regionid;
+					region.push_back(adjacentface);
+				}
+			}
 		}
 	}
+
+	// Without an unbounded region, the largest one is the outer hull
+	if (!regions.empty() && std::find(bounded.begin(), bounded.end(), false) == bounded.end())
+	{
+		int outer = 0;
+		for (int r = 1; r < (int)regions.size(); ++r)
+			if (regions[r].size() > regions[outer].size())
+				outer = r;
+
+		bounded[outer] = false;
+	}
+
+	bool filled = false;
+
+	for (int r = 0; r < (int)regions.size(); ++r)
+	{
+		bool hole = bounded[r];
+		for (int j = 0; j < (int)regions[r].size(); ++j)
+		{
+			regions[r][j]->iterationid = hole ? iterationId : -1;
+			if (hole)
+				visiblefaces.push_back(regions[r][j]);
+		}
+
+		filled |= hole;
+	}
+
+	return filled;
 }
 inline std::vector<QHull3d::HEEdge*> QHull3d::getHorizonEdgeLoop(const int iterationId, const std::vector<HEFace*>& visiblefaces, const gk::Point& p, bool& onedge) const
 {
@@ -714,28 +1528,28 @@ inline std::vector<QHull3d::HEEdge*> QHull3d::getHorizonEdgeLoop(const int itera
 
 	onedge = false;
 
-	// Get a first horizon edge
+	// Get a first horizon edge, and count them all
 	HEEdge* starthorizonedge = nullptr;
+	int horizonedgecount = 0;
 
 	for (int f = 0; f < (int)visiblefaces.size(); ++f)
 	{
 		HEEdge* edge = visiblefaces[f]->edge;
-		for (int i = 0; i < 3; ++i)
+		for (int i = 0; i < 3; ++i, edge = edge->next)
 		{
 			if (edge->coedge->face->iterationid != iterationId)
 			{
-				starthorizonedge = edge;
+				if (!starthorizonedge)
+					starthorizonedge = edge;
 
-				break;
+				++horizonedgecount;
 			}
-
-			edge = edge->next;
 		}
-
-		if (starthorizonedge)
-			break;
 	}
 
+	if (!starthorizonedge)
+		return horizonedgeloop;
+
 	// Detect point-on-edge case
 	if (isOnEdge(
 		starthorizonedge->vertex->getPoint(),
@@ -752,8 +1566,13 @@ inline std::vector<QHull3d::HEEdge*> QHull3d::getHorizonEdgeLoop(const int itera
 
 	horizonedgeloop.push_back(starthorizonedge);
 
-	while ((nexthorizonedge = getNextHorizonEdge(iterationId, currenthorizonedge)) != starthorizonedge)
+	// Bounded walk: on degenerate inputs, the visible set may have holes or touch itself at a vertex,
+	// making the walk cycle without reaching its start, or miss a part of the horizon
+	while ((nexthorizonedge = getNextHorizonEdge(iterationId, currenthorizonedge, (int)_edges.size())) != starthorizonedge)
 	{
+		if (!nexthorizonedge || (int)horizonedgeloop.size() == horizonedgecount)
+			return std::vector<QHull3d::HEEdge*>();
+
 		// Detect point-on-edge case
 		if (isOnEdge(
 			nexthorizonedge->vertex->getPoint(),
@@ -769,14 +1588,31 @@ inline std::vector<QHull3d::HEEdge*> QHull3d::getHorizonEdgeLoop(const int itera
 		currenthorizonedge = nexthorizonedge;
 	}
 
+	if ((int)horizonedgeloop.size() != horizonedgecount)
+		return std::vector<QHull3d::HEEdge*>();
+
+	// The loop must be simple: each horizon vertex passed once
+	std::vector<const HEVertex*> loopvertices(horizonedgeloop.size());
+	for (int i = 0; i < (int)horizonedgeloop.size(); ++i)
+		loopvertices[i] = horizonedgeloop[i]->vertex;
+
+	std::sort(loopvertices.begin(), loopvertices.end());
+	if (std::adjacent_find(loopvertices.begin(), loopvertices.end()) != loopvertices.end())
+		return std::vector<QHull3d::HEEdge*>();
+
 	return horizonedgeloop;
 }
-inline QHull3d::HEEdge* QHull3d::getNextHorizonEdge(const int iterationId, HEEdge* horizonedge) const
+inline QHull3d::HEEdge* QHull3d::getNextHorizonEdge(const int iterationId, HEEdge* horizonedge, int maxsteps) const
 {
 	// Turn around the specified edge's target vertex until the bordered face is visible
 	horizonedge = horizonedge->coedge;
 	while (horizonedge->face->iterationid != iterationId)
+	{
+		if (maxsteps-- == 0)
+			return nullptr;
+
 		horizonedge = horizonedge->next->next->coedge;
+	}
 
 	return horizonedge;
 }
@@ -785,5 +1621,17 @@ inline bool QHull3d::isOnEdge(const gk::Point& e1, const gk::Point& e2, const gk
 	gk::Vector n = gk::Cross(e2 -e1, p - e1);
 	return (n.x == 0 && n.y == 0 && n.z == 0 && gk::BBox(e1, e2).Inside(p));
 }
+inline bool QHull3d::isFoldingEdge(const HEEdge* edge, const gk::Point& p) const
+{
+	const gk::Point& e1 = edge->next->next->vertex->getPoint();
+	const gk::Vector& n = edge->coedge->face->normal();
+	gk::Vector e12(e1, edge->vertex->getPoint());
+
+	// Signed distances to the edge's line within the co-face's plane, times the edge length
+	float pside = gk::Dot(gk::Cross(e12, gk::Vector(e1, p)), n);
+	float apexside = gk::Dot(gk::Cross(e12, gk::Vector(e1, edge->coedge->next->vertex->getPoint())), n);
+
+	return std::fabs(pside) <= _epsilon * e12.Length() || (pside > 0) == (apexside > 0);
+}
 
 #endif
\ No newline at end of file
@@ -0,0 +1,551 @@
+#include "chanhull_2d.h"
+#include "jhull_2d.h"
+#include "mhull_2d.h"
+#include "point_order.h"
+#include "qhull_3d.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#define BENCH_CLUSTER_COUNT		16
+#define BENCH_CLUSTER_SIGMA		0.02f
+#define BENCH_NEAR_COPLANAR		1e-4f
+#define BENCH_GRID_STEP			0.1f
+#define BENCH_REMOVAL_TOLERANCE	1e-4f		//! Distance allowed above a repaired hull beyond the built one's, for the unit-sized distributions
+
+//! Benchmarked point distributions.
+static const char* DISTRIBUTIONS[] = {
+	"cube",				//! Uniform within the unit cube
+	"ball",				//! Uniform within the unit ball
+	"sphere",			//! Uniform on the unit sphere: all the points are on the hull
+	"gaussian",			//! Standard normal
+	"clustered",		//! Normal clusters around uniform centers
+	"coplanar",			//! Uniform within the unit square of the z = 0.5 plane
+	"nearcoplanar",		//! Uniform within a thin slab around the z = 0.5 plane
+	"cubesurface",		//! Uniform on the unit cube's faces: coplanar hull faces
+	"grid"				//! Random nodes of a lattice within the unit cube: coplanar points and duplicates
+};
+static const int DISTRIBUTION_COUNT = sizeof(DISTRIBUTIONS) / sizeof(DISTRIBUTIONS[0]);
+
+//! Benchmarked input orders (-order).
+static const char* ORDERS[] = {
+	"none",				//! Generation order: random
+	"morton",			//! Reordered along a Morton curve
+	"hilbert"			//! Reordered along a Hilbert curve
+};
+static const int ORDER_COUNT = sizeof(ORDERS) / sizeof(ORDERS[0]);
+
+//! Benchmarked 2D point distributions (-2d).
+static const char* DISTRIBUTIONS_2D[] = {
+	"square",			//! Uniform within the unit square: tiny hull
+	"disk",				//! Uniform within the unit disk: hull size growing as n^(1/3)
+	"circle"			//! Uniform on the unit circle: all the points are on the hull
+};
+static const int DISTRIBUTION_2D_COUNT = sizeof(DISTRIBUTIONS_2D) / sizeof(DISTRIBUTIONS_2D[0]);
+
+//! Benchmarked 2D engines (-2d).
+static const char* ENGINES_2D[] = {
+	"jhull",			//! Jarvis march, O(n h)
+	"mhull",			//! Monotone chain, O(n log n)
+	"chan"				//! Chan's algorithm, O(n log h)
+};
+static const int ENGINE_2D_COUNT = sizeof(ENGINES_2D) / sizeof(ENGINES_2D[0]);
+
+//! Generate the specified distribution's points.
+static std::vector<gk::Point> generatePoints(const std::string& distribution, long long count, unsigned int seed)
+{
+	std::mt19937 generator(seed);
+	std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+	std::normal_distribution<float> normal(0.0f, 1.0f);
+
+	std::vector<gk::Point> points((size_t)count);
+
+	if (distribution == "cube")
+	{
+		for (gk::Point& p : points)
+			p = gk::Point(uniform(generator), uniform(generator), uniform(generator));
+	}
+	else if (distribution == "ball")
+	{
+		for (gk::Point& p : points)
+		{
+			do
+				p = gk::Point(2 * uniform(generator) - 1, 2 * uniform(generator) - 1, 2 * uniform(generator) - 1);
+			while (p.x * p.x + p.y * p.y + p.z * p.z > 1);
+		}
+	}
+	else if (distribution == "sphere")
+	{
+		for (gk::Point& p : points)
+		{
+			gk::Vector v;
+			do
+				v = gk::Vector(normal(generator), normal(generator), normal(generator));
+			while (v.LengthSquared() == 0);
+
+			p = gk::Point(gk::Normalize(v));
+		}
+	}
+	else if (distribution == "gaussian")
+	{
+		for (gk::Point& p : points)
+			p = gk::Point(normal(generator), normal(generator), normal(generator));
+	}
+	else if (distribution == "clustered")
+	{
+		gk::Point centers[BENCH_CLUSTER_COUNT];
+		for (gk::Point& c : centers)
+			c = gk::Point(uniform(generator), uniform(generator), uniform(generator));
+
+		for (long long i = 0; i < count; ++i)
+		{
+			const gk::Point& c = centers[i % BENCH_CLUSTER_COUNT];
+			points[i] = gk::Point(
+				c.x + BENCH_CLUSTER_SIGMA * normal(generator),
+				c.y + BENCH_CLUSTER_SIGMA * normal(generator),
+				c.z + BENCH_CLUSTER_SIGMA * normal(generator));
+		}
+	}
+	else if (distribution == "coplanar")
+	{
+		for (gk::Point& p : points)
+			p = gk::Point(uniform(generator), uniform(generator), 0.5f);
+	}
+	else if (distribution == "nearcoplanar")
+	{
+		for (gk::Point& p : points)
+			p = gk::Point(uniform(generator), uniform(generator), 0.5f + BENCH_NEAR_COPLANAR * uniform(generator));
+	}
+	else if (distribution == "cubesurface")
+	{
+		std::uniform_int_distribution<int> side(0, 5);
+		for (gk::Point& p : points)
+		{
+			float c[3] = { uniform(generator), uniform(generator), uniform(generator) };
+			int s = side(generator);
+			c[s % 3] = (float)(s / 3);
+			p = gk::Point(c[0], c[1], c[2]);
+		}
+	}
+	else if (distribution == "grid")
+	{
+		std::uniform_int_distribution<int> node(0, (int)(1 / BENCH_GRID_STEP));
+		for (gk::Point& p : points)
+			p = gk::Point(BENCH_GRID_STEP * node(generator), BENCH_GRID_STEP * node(generator), BENCH_GRID_STEP * node(generator));
+	}
+	else
+	{
+		points.clear();
+	}
+
+	return points;
+}
+
+//! Generate the specified 2D distribution's points.
+static std::vector<gk::Vec2> generatePoints2d(const std::string& distribution, long long count, unsigned int seed)
+{
+	std::mt19937 generator(seed);
+	std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+
+	std::vector<gk::Vec2> points((size_t)count);
+
+	if (distribution == "square")
+	{
+		for (gk::Vec2& p : points)
+			p = gk::Vec2(uniform(generator), uniform(generator));
+	}
+	else if (distribution == "disk")
+	{
+		for (gk::Vec2& p : points)
+		{
+			do
+				p = gk::Vec2(2 * uniform(generator) - 1, 2 * uniform(generator) - 1);
+			while (p.x * p.x + p.y * p.y > 1);
+		}
+	}
+	else if (distribution == "circle")
+	{
+		for (gk::Vec2& p : points)
+		{
+			float angle = 2 * (float)M_PI * uniform(generator);
+			p = gk::Vec2(std::cos(angle), std::sin(angle));
+		}
+	}
+	else
+	{
+		points.clear();
+	}
+
+	return points;
+}
+
+//! Create the specified 2D engine.
+static std::unique_ptr<ConvexHull2d> createEngine2d(const std::string& engine)
+{
+	if (engine == "jhull")
+		return std::make_unique<JHull2d>();
+	if (engine == "mhull")
+		return std::make_unique<MHull2d>();
+	if (engine == "chan")
+		return std::make_unique<ChanHull2d>();
+
+	return nullptr;
+}
+
+//! Split the specified comma separated list.
+static std::vector<std::string> splitList(const std::string& list)
+{
+	std::vector<std::string> items;
+
+	for (size_t first = 0, comma; first <= list.size(); first = comma + 1)
+	{
+		comma = list.find(',', first);
+		if (comma == std::string::npos)
+			comma = list.size();
+
+		if (comma > first)
+			items.push_back(list.substr(first, comma - first));
+	}
+
+	return items;
+}
+
+static void printUsage()
+{
+	printf(
+		"usage: qhullbench [options]\n"
+		"  -d <list>        comma separated distributions (default: all)\n"
+		"  -2d              benchmark the 2D engines on 2D distributions\n"
+		"  -e <list>        comma separated 2D engines (default: mhull,chan)\n"
+		"  -order <list>    comma separated input orders, the reordering being timed within the total (default: none)\n"
+		"  -min <count>     smallest point count (default: 1000)\n"
+		"  -max <count>     largest point count, sizes growing by 10x (default: 1000000, up to 100000000)\n"
+		"  -r <count>       runs per distribution and size (default: 3)\n"
+		"  -s <seed>        random seed (default: 1)\n"
+		"  -removal <count> remove up to count hull vertices per run, checking each repaired hull against the\n"
+		"                   remaining points, in O(faces x points): use small sizes (exits with 2 on failure)\n"
+		"  -o <file>        CSV output file (default: standard output)\n"
+		"distributions:");
+	for (int i = 0; i < DISTRIBUTION_COUNT; ++i)
+		printf(" %s", DISTRIBUTIONS[i]);
+	printf("\norders:");
+	for (int i = 0; i < ORDER_COUNT; ++i)
+		printf(" %s", ORDERS[i]);
+	printf("\n2D distributions:");
+	for (int i = 0; i < DISTRIBUTION_2D_COUNT; ++i)
+		printf(" %s", DISTRIBUTIONS_2D[i]);
+	printf("\n2D engines:");
+	for (int i = 0; i < ENGINE_2D_COUNT; ++i)
+		printf(" %s", ENGINES_2D[i]);
+	printf("\n");
+}
+
+//! Benchmark the specified 2D engines, one CSV line per run.
+static void run2d(FILE* file, const std::vector<std::string>& distributions, const std::vector<std::string>& engines,
+	long long mincount, long long maxcount, int runs, unsigned int seed)
+{
+	fprintf(file, "distribution,points,run,engine,vertices,iterations,total_ms\n");
+	fflush(file);
+
+	for (const std::string& distribution : distributions)
+	{
+		for (long long count = mincount; count <= maxcount; count *= 10)
+		{
+			for (int run = 0; run < runs; ++run)
+			{
+				std::vector<gk::Vec2> points = generatePoints2d(distribution, count, seed + run);
+				if (points.empty())
+				{
+					fprintf(stderr, "Unknown distribution %s\n", distribution.c_str());
+					break;
+				}
+
+				for (const std::string& engine : engines)
+				{
+					std::unique_ptr<ConvexHull2d> hull = createEngine2d(engine);
+					if (!hull)
+					{
+						fprintf(stderr, "Unknown engine %s\n", engine.c_str());
+						continue;
+					}
+
+					std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+					hull->initialize(&points[0], (int)points.size());
+
+					int iterations = hull->build();
+					std::vector<int> vertices = hull->hull();
+
+					double total = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+					fprintf(file, "%s,%lld,%d,%s,%d,%d,%.3f\n",
+						distribution.c_str(), count, run, engine.c_str(), (int)vertices.size(), iterations, total);
+					fflush(file);
+				}
+			}
+		}
+	}
+}
+
+//! Get the largest distance of the remaining points above the hull's faces,
+//! or infinity if the hull is not a closed genus 0 manifold whose vertices all remain.
+static float hullOutsideDistance(const QHull3d& qhull, const std::vector<gk::Point>& points)
+{
+	QHull3d::Mesh mesh = qhull.mesh();
+
+	long long facecount = (long long)mesh.faces.size();
+	if (facecount < 4 || std::find(mesh.neighbors.begin(), mesh.neighbors.end(), -1) != mesh.neighbors.end() ||
+		(long long)mesh.edges.size() * 2 != facecount * 3 ||
+		(long long)mesh.vertices.size() - (long long)mesh.edges.size() + facecount != 2)
+		return INFINITY;
+
+	for (int vertex : mesh.vertices)
+	{
+		if (qhull.isRemoved(vertex))
+			return INFINITY;
+	}
+
+	float outside = 0;
+	for (const ConvexHull3d::Face& face : mesh.faces)
+	{
+		const gk::Point& a = points[face.idx[0]];
+		gk::Vector n = gk::Cross(gk::Vector(a, points[face.idx[1]]), gk::Vector(a, points[face.idx[2]]));
+		if (n.LengthSquared() == 0)
+			continue;
+
+		n = gk::Normalize(n);
+		for (size_t i = 0; i < points.size(); ++i)
+		{
+			if (!qhull.isRemoved((int)i))
+				outside = std::max(outside, gk::Dot(n, gk::Vector(a, points[i])));
+		}
+	}
+
+	return outside;
+}
+
+//! Remove up to the specified number of random hull vertices per run, checking each repaired hull,
+//! one CSV line per run. Returns the number of runs left with an invalid hull.
+static int runRemoval(FILE* file, const std::vector<std::string>& distributions,
+	long long mincount, long long maxcount, int runs, unsigned int seed, int removals)
+{
+	int invalidruns = 0;
+
+	fprintf(file, "distribution,points,run,removals,rebuilds,invalid,build_outside,max_outside,total_ms\n");
+	fflush(file);
+
+	for (const std::string& distribution : distributions)
+	{
+		for (long long count = mincount; count <= maxcount; count *= 10)
+		{
+			for (int run = 0; run < runs; ++run)
+			{
+				std::vector<gk::Point> points = generatePoints(distribution, count, seed + run);
+				if (points.empty())
+				{
+					fprintf(stderr, "Unknown distribution %s\n", distribution.c_str());
+					break;
+				}
+
+				std::mt19937 generator(seed + run);
+
+				QHull3d qhull;
+				qhull.setRetainInteriorPoints(true);
+				qhull.initialize(&points[0], (int)points.size());
+				qhull.build();
+
+				// Removals are checked against the built hull's own accuracy
+				float buildoutside = hullOutsideDistance(qhull, points);
+				int removed = 0, rebuilds = 0, invalid = 0;
+				float maxoutside = 0;
+				double total = 0;
+
+				while (removed < removals)
+				{
+					std::vector<int> vertices = qhull.hullVertices();
+					if ((long long)vertices.size() <= 4)
+						break;
+
+					int vertex = vertices[std::uniform_int_distribution<int>(0, (int)vertices.size() - 1)(generator)];
+
+					std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+					bool done = qhull.removePoint(vertex);
+					total += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+					if (!done)
+						break;
+
+					++removed;
+					// A failed cavity repair falls back to a full rebuild, involving all the points
+					rebuilds += (qhull.lastRepairPointCount() == (int)points.size());
+
+					float outside = hullOutsideDistance(qhull, points);
+					maxoutside = std::max(maxoutside, outside);
+					invalid += (outside > buildoutside + BENCH_REMOVAL_TOLERANCE);
+				}
+
+				if (invalid)
+				{
+					fprintf(stderr, "%s %lld run %d: %d invalid hulls after removal\n", distribution.c_str(), count, run, invalid);
+					++invalidruns;
+				}
+
+				fprintf(file, "%s,%lld,%d,%d,%d,%d,%g,%g,%.3f\n",
+					distribution.c_str(), count, run, removed, rebuilds, invalid, buildoutside, maxoutside, total);
+				fflush(file);
+			}
+		}
+	}
+
+	return invalidruns;
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<std::string> distributions;
+	std::vector<std::string> engines = { "mhull", "chan" };
+	std::vector<std::string> orders = { "none" };
+	bool planar = false;
+	int removals = 0;
+	long long mincount = 1000;
+	long long maxcount = 1000000;
+	int runs = 3;
+	unsigned int seed = 1;
+	std::string output;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		bool hasvalue = i + 1 < argc;
+
+		if (!strcmp(argv[i], "-d") && hasvalue)
+			distributions = splitList(argv[++i]);
+		else if (!strcmp(argv[i], "-2d"))
+			planar = true;
+		else if (!strcmp(argv[i], "-e") && hasvalue)
+			engines = splitList(argv[++i]);
+		else if (!strcmp(argv[i], "-order") && hasvalue)
+			orders = splitList(argv[++i]);
+		else if (!strcmp(argv[i], "-min") && hasvalue)
+			mincount = std::max(atoll(argv[++i]), 4LL);
+		else if (!strcmp(argv[i], "-max") && hasvalue)
+			maxcount = std::min(atoll(argv[++i]), 100000000LL);
+		else if (!strcmp(argv[i], "-r") && hasvalue)
+			runs = std::max(atoi(argv[++i]), 1);
+		else if (!strcmp(argv[i], "-s") && hasvalue)
+			seed = (unsigned int)atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-removal") && hasvalue)
+			removals = std::max(atoi(argv[++i]), 1);
+		else if (!strcmp(argv[i], "-o") && hasvalue)
+			output = argv[++i];
+		else
+		{
+			printUsage();
+			return 1;
+		}
+	}
+
+	FILE* file = output.empty() ? stdout : fopen(output.c_str(), "w");
+	if (!file)
+	{
+		fprintf(stderr, "Failed to open %s\n", output.c_str());
+		return 1;
+	}
+
+	if (distributions.empty())
+	{
+		if (planar)
+			distributions.assign(DISTRIBUTIONS_2D, DISTRIBUTIONS_2D + DISTRIBUTION_2D_COUNT);
+		else
+			distributions.assign(DISTRIBUTIONS, DISTRIBUTIONS + DISTRIBUTION_COUNT);
+	}
+
+	if (planar)
+	{
+		run2d(file, distributions, engines, mincount, maxcount, runs, seed);
+
+		if (file != stdout)
+			fclose(file);
+
+		return 0;
+	}
+
+	if (removals)
+	{
+		int invalidruns = runRemoval(file, distributions, mincount, maxcount, runs, seed, removals);
+
+		if (file != stdout)
+			fclose(file);
+
+		return invalidruns ? 2 : 0;
+	}
+
+	fprintf(file, "distribution,points,run,order,faces,iterations,order_ms,vertices_ms,simplex_ms,partition_ms,iterations_ms,extraction_ms,total_ms\n");
+	fflush(file);
+
+	for (const std::string& distribution : distributions)
+	{
+		for (long long count = mincount; count <= maxcount; count *= 10)
+		{
+			for (int run = 0; run < runs; ++run)
+			{
+				std::vector<gk::Point> points = generatePoints(distribution, count, seed + run);
+				if (points.empty())
+				{
+					fprintf(stderr, "Unknown distribution %s\n", distribution.c_str());
+					break;
+				}
+
+				for (const std::string& order : orders)
+				{
+					if (order != "none" && order != "morton" && order != "hilbert")
+					{
+						fprintf(stderr, "Unknown order %s\n", order.c_str());
+						continue;
+					}
+
+					std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+					// Hull the reordered points, then remap the faces to the generated order
+					PointOrder reorder((order == "morton") ? PointOrder::Morton : PointOrder::Hilbert);
+					if (order != "none")
+						reorder.run(&points[0], (int)points.size());
+
+					double orderms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+					QHull3d qhull;
+					qhull.initialize((order != "none") ? reorder.points() : &points[0], (int)points.size());
+
+					int iterations = qhull.build();
+					std::vector<ConvexHull3d::Face> faces = qhull.hull();
+
+					if (qhull.failed())
+						fprintf(stderr, "%s %lld run %d: build failed\n", distribution.c_str(), count, run);
+
+					if (order != "none")
+						reorder.remap(faces);
+
+					double total = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+					const QHull3d::Timings& timings = qhull.timings();
+					fprintf(file, "%s,%lld,%d,%s,%d,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n",
+						distribution.c_str(), count, run, order.c_str(), (int)faces.size(), iterations, orderms,
+						timings.vertices, timings.simplex, timings.partition, timings.iterations, timings.extraction, total);
+					fflush(file);
+				}
+			}
+		}
+	}
+
+	if (file != stdout)
+		fclose(file);
+
+	return 0;
+}
@@ -0,0 +1,464 @@
+#include "binary_point_file.h"
+#include "hull_export.h"
+#include "point_dedup.h"
+#include "point_order.h"
+#include "qhull_3d.h"
+#include "qhull_stream.h"
+#include "qhull_trace.h"
+#include "text_point_file.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#define DEFAULT_CHUNK_SIZE	(1 << 20)
+
+//! Hull engines.
+enum Engine
+{
+	EngineQHull,		//! In-core QHull3d
+	EngineStream		//! Chunked QHullStream
+};
+
+//! Command line options.
+struct Options
+{
+	std::string input;
+	std::string output;
+	std::string trace;
+
+	Engine engine = EngineQHull;
+	int chunksize = DEFAULT_CHUNK_SIZE;
+	int threadcount = 0;
+	float quantum = -1.f;
+	std::string order;
+
+	bool normals = false;
+	bool allpoints = false;
+	bool verticesonly = false;
+	bool timings = false;
+	bool stats = false;
+	bool memory = false;
+	bool quiet = false;
+};
+
+//! Wall clock phase timer.
+class Timer
+{
+private:
+
+	std::chrono::steady_clock::time_point _start;
+
+public:
+
+	Timer() : _start(std::chrono::steady_clock::now()) {}
+
+	//! Get the elapsed time in milliseconds, and restart.
+	double lap()
+	{
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		double ms = std::chrono::duration<double, std::milli>(now - _start).count();
+		_start = now;
+
+		return ms;
+	}
+};
+
+static void printUsage()
+{
+	printf(
+		"usage: qhullcli [options] <input> [output]\n"
+		"  input                point file: binary (.qhp) or text (one \"x y z\" point per line)\n"
+		"  output               hull file, by extension: .ply, .stl, .obj (mesh), .qhp, .txt (hull vertices)\n"
+		"  -e qhull|stream      hull engine (default: qhull)\n"
+		"  -c <count>           stream engine chunk size (default: %d)\n"
+		"  -j <count>           text parser and prepass thread count (default: 0, all cores)\n"
+		"  -d <quantum>         eliminate duplicate points before the build (qhull engine), merging the points\n"
+		"                       of a same grid cell of the specified size (0: exact duplicates only)\n"
+		"  -order <curve>       reorder the points along a morton or hilbert curve before the build (qhull engine)\n"
+		"  -n                   write per-face normals\n"
+		"  -a                   write all the input points instead of the hull vertices only (qhull engine)\n"
+		"  -v                   build the hull vertices only, without the face list (point file output)\n"
+		"  -t                   print phase timings\n"
+		"  -s                   print build statistics (qhull engine, QHULL_STATS builds)\n"
+		"  -m                   print current and peak hull memory (qhull engine)\n"
+		"  -trace <file>        write a trace_event JSON timeline\n"
+		"  -q                   quiet\n",
+		DEFAULT_CHUNK_SIZE);
+}
+
+//! Get whether the specified file is a point file (by extension), rather than a mesh file.
+static bool isPointFile(const std::string& filename)
+{
+	size_t dot = filename.rfind('.');
+	std::string extension = (dot != std::string::npos) ? filename.substr(dot + 1) : std::string();
+
+	return extension == "qhp" || extension == "txt" || extension == "xyz";
+}
+
+static bool parseOptions(int argc, char** argv, Options& options)
+{
+	std::vector<std::string> files;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const char* arg = argv[i];
+		bool hasvalue = i + 1 < argc;
+
+		if (!strcmp(arg, "-e") && hasvalue)
+		{
+			const char* engine = argv[++i];
+			if (!strcmp(engine, "qhull"))
+				options.engine = EngineQHull;
+			else if (!strcmp(engine, "stream"))
+				options.engine = EngineStream;
+			else
+				return false;
+		}
+		else if (!strcmp(arg, "-c") && hasvalue)
+			options.chunksize = std::max(atoi(argv[++i]), 4);
+		else if (!strcmp(arg, "-j") && hasvalue)
+			options.threadcount = std::max(atoi(argv[++i]), 0);
+		else if (!strcmp(arg, "-d") && hasvalue)
+			options.quantum = std::max((float)atof(argv[++i]), 0.f);
+		else if (!strcmp(arg, "-order") && hasvalue)
+		{
+			options.order = argv[++i];
+			if (options.order != "morton" && options.order != "hilbert")
+				return false;
+		}
+		else if (!strcmp(arg, "-n"))
+			options.normals = true;
+		else if (!strcmp(arg, "-a"))
+			options.allpoints = true;
+		else if (!strcmp(arg, "-v"))
+			options.verticesonly = true;
+		else if (!strcmp(arg, "-t"))
+			options.timings = true;
+		else if (!strcmp(arg, "-s"))
+			options.stats = true;
+		else if (!strcmp(arg, "-m"))
+			options.memory = true;
+		else if (!strcmp(arg, "-trace") && hasvalue)
+			options.trace = argv[++i];
+		else if (!strcmp(arg, "-q"))
+			options.quiet = true;
+		else if (arg[0] == '-')
+			return false;
+		else
+			files.push_back(arg);
+	}
+
+	if (files.empty() || files.size() > 2)
+		return false;
+
+	options.input = files[0];
+	options.output = (files.size() > 1) ? files[1] : std::string();
+
+	// Without faces, there is no mesh to write
+	if (options.verticesonly && !options.output.empty() && !isPointFile(options.output))
+		return false;
+
+	return true;
+}
+
+//! Write the specified points to the output point file.
+static bool writePoints(const Options& options, const std::vector<gk::Point>& vertices)
+{
+	const gk::Point* data = vertices.empty() ? nullptr : &vertices[0];
+	if (options.output.compare(options.output.size() - 4, 4, ".qhp") == 0)
+		return BinaryPointFile::write(options.output, data, (long long)vertices.size());
+
+	return TextPointFile::write(options.output, data, (long long)vertices.size());
+}
+
+//! Write the specified hull vertices, by input index, or all the points.
+static bool writeVertices(const Options& options, const gk::Point* points, int count, const std::vector<int>& indices)
+{
+	std::vector<gk::Point> vertices;
+	if (options.allpoints)
+		vertices.assign(points, points + count);
+	else
+	{
+		vertices.reserve(indices.size());
+		for (int index : indices)
+			vertices.push_back(points[index]);
+	}
+
+	return writePoints(options, vertices);
+}
+
+//! Write the specified hull's vertices, or its mesh.
+static bool writeHull(const Options& options, const gk::Point* points, int count, const std::vector<ConvexHull3d::Face>& faces)
+{
+	if (isPointFile(options.output))
+	{
+		std::vector<gk::Point> vertices;
+		if (options.allpoints)
+		{
+			vertices.assign(points, points + count);
+		}
+		else
+		{
+			std::vector<char> used(count, 0);
+			for (const ConvexHull3d::Face& face : faces)
+				for (int k = 0; k < 3; ++k)
+					used[face.idx[k]] = 1;
+
+			for (int i = 0; i < count; ++i)
+				if (used[i])
+					vertices.push_back(points[i]);
+		}
+
+		return writePoints(options, vertices);
+	}
+
+	int exportoptions = (options.normals ? HullExport::Normals : 0) | (options.allpoints ? 0 : HullExport::Compact);
+
+	return HullExport::write(options.output, points, count, faces, exportoptions);
+}
+
+//! Print the specified hull memory, in megabytes.
+static void printMemory(const char* name, const QHull3d::Memory& memory)
+{
+	const double mb = 1.0 / (1024 * 1024);
+
+	printf("%s memory %.3f MB: vertices %.3f, edges %.3f, faces %.3f, conflicts %.3f, points %.3f, points2d %.3f, scratch %.3f\n",
+		name, memory.total() * mb, memory.vertices * mb, memory.edges * mb, memory.faces * mb,
+		memory.conflicts * mb, memory.points * mb, memory.points2d * mb, memory.scratch * mb);
+}
+
+static int runQHull(const Options& options)
+{
+	Timer timer;
+	Timer total;
+
+	// Read, without copy for float3 binary files
+	BinaryPointFile binaryfile;
+	std::vector<gk::Point> decoded;
+	const gk::Point* points = nullptr;
+	long long count = 0;
+
+	if (binaryfile.open(options.input))
+	{
+		count = binaryfile.count();
+		points = binaryfile.points();
+		if (!points)
+		{
+			decoded = binaryfile.decode();
+			points = decoded.empty() ? nullptr : &decoded[0];
+		}
+	}
+	else if (TextPointFile::read(options.input, decoded, options.threadcount))
+	{
+		count = (long long)decoded.size();
+		points = decoded.empty() ? nullptr : &decoded[0];
+	}
+	else
+	{
+		fprintf(stderr, "Failed to read points from %s\n", options.input.c_str());
+		return 2;
+	}
+
+	if (count > 0x7fffffff)
+	{
+		fprintf(stderr, "%lld points exceed the qhull engine capacity, use the stream engine\n", count);
+		return 2;
+	}
+
+	double readms = timer.lap();
+
+	// Eliminate duplicates, the hull being built over the unique points then remapped to the input indices
+	PointDedup dedup(options.quantum, options.threadcount);
+	bool deduplicate = options.quantum >= 0;
+
+	if (deduplicate)
+		dedup.run(points, (int)count);
+
+	// Reorder, the hull being built over the reordered points then remapped to the unique or input indices
+	PointOrder reorder((options.order == "morton") ? PointOrder::Morton : PointOrder::Hilbert, options.threadcount);
+	bool reordered = !options.order.empty();
+
+	const gk::Point* hullpoints = deduplicate ? dedup.points() : points;
+	int hullcount = deduplicate ? dedup.count() : (int)count;
+
+	if (reordered)
+	{
+		reorder.run(hullpoints, hullcount);
+		hullpoints = reorder.points();
+	}
+
+	double prepassms = timer.lap();
+
+	// Build
+	QHull3d qhull;
+	qhull.initialize(hullpoints, hullcount);
+
+	double initializems = timer.lap();
+
+	int iterations = qhull.build();
+
+	if (qhull.failed())
+	{
+		fprintf(stderr, "Failed to build the hull: inconsistent horizon on degenerate input\n");
+		return 4;
+	}
+
+	// Extract the hull vertices only, or the faces
+	std::vector<ConvexHull3d::Face> faces;
+	std::vector<int> vertices;
+
+	if (options.verticesonly)
+	{
+		vertices = qhull.hullVertices();
+
+		if (reordered)
+			reorder.remap(vertices);
+		if (deduplicate)
+			dedup.remap(vertices);
+		if (reordered || deduplicate)
+			std::sort(vertices.begin(), vertices.end());
+	}
+	else
+	{
+		faces = qhull.hull();
+
+		if (reordered)
+			reorder.remap(faces);
+		if (deduplicate)
+			dedup.remap(faces);
+	}
+
+	double buildms = timer.lap();
+
+	// Write
+	if (!options.output.empty() && !(options.verticesonly ?
+		writeVertices(options, points, (int)count, vertices) :
+		writeHull(options, points, (int)count, faces)))
+	{
+		fprintf(stderr, "Failed to write hull to %s\n", options.output.c_str());
+		return 3;
+	}
+
+	double writems = timer.lap();
+
+	if (!options.quiet)
+	{
+		if (options.verticesonly)
+			printf("%lld points, %d hull vertices, %d iterations\n", count, (int)vertices.size(), iterations);
+		else
+			printf("%lld points, %d faces, %d iterations\n", count, (int)faces.size(), iterations);
+		if (deduplicate)
+			printf("%d unique points\n", dedup.count());
+
+		static const char* dimensions[] = { "empty", "singular", "linear", "planar" };
+		if (qhull.dimension() != QHull3d::Volumetric)
+			printf("%s input, %d degenerate hull vertices\n", dimensions[qhull.dimension() + 1], (int)qhull.degenerateHull().size());
+	}
+	if (options.timings)
+		printf("read %.3f ms, prepass %.3f ms, initialize %.3f ms, build %.3f ms, write %.3f ms, total %.3f ms\n",
+			readms, prepassms, initializems, buildms, writems, total.lap());
+	if (options.stats)
+		qhull.stats().print(stdout);
+	if (options.memory)
+	{
+		printMemory("current", qhull.memory());
+		printMemory("peak", qhull.peakMemory());
+	}
+
+	return 0;
+}
+
+static int runStream(const Options& options)
+{
+	Timer timer;
+	Timer total;
+
+	QHullStream stream(options.chunksize);
+	stream.setBuildFaces(!options.verticesonly);
+
+	// Read and build by chunks: binary files are decoded chunk by chunk, text files are parsed at once
+	BinaryPointFile binaryfile;
+	if (binaryfile.open(options.input))
+	{
+		long long next = 0;
+
+		stream.build([&](gk::Point* points, int count)
+		{
+			int n = (int)std::min<long long>(count, binaryfile.count() - next);
+			binaryfile.decode(next, n, points);
+			next += n;
+
+			return n;
+		});
+	}
+	else
+	{
+		std::vector<gk::Point> points;
+		if (!TextPointFile::read(options.input, points, options.threadcount))
+		{
+			fprintf(stderr, "Failed to read points from %s\n", options.input.c_str());
+			return 2;
+		}
+
+		for (size_t first = 0; first < points.size(); first += options.chunksize)
+			stream.add(&points[first], (int)std::min<size_t>(options.chunksize, points.size() - first));
+
+		stream.flush();
+	}
+
+	double buildms = timer.lap();
+
+	// Write
+	std::vector<gk::Point> vertices = stream.vertices();
+	const std::vector<ConvexHull3d::Face>& faces = stream.hull();
+
+	Options writeoptions = options;
+	writeoptions.allpoints = false;
+
+	if (!options.output.empty() && !(options.verticesonly ?
+		writePoints(options, vertices) :
+		writeHull(writeoptions, vertices.empty() ? nullptr : &vertices[0], (int)vertices.size(), faces)))
+	{
+		fprintf(stderr, "Failed to write hull to %s\n", options.output.c_str());
+		return 3;
+	}
+
+	double writems = timer.lap();
+
+	if (!options.quiet)
+	{
+		if (options.verticesonly)
+			printf("%lld points, %d hull vertices\n", stream.pointCount(), (int)vertices.size());
+		else
+			printf("%lld points, %d faces, %d hull vertices\n", stream.pointCount(), (int)faces.size(), (int)vertices.size());
+	}
+	if (options.timings)
+		printf("read and build %.3f ms, write %.3f ms, total %.3f ms\n", buildms, writems, total.lap());
+
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	if (!parseOptions(argc, argv, options))
+	{
+		printUsage();
+		return 1;
+	}
+
+	if (!options.trace.empty())
+		QHullTrace::start();
+
+	int result = (options.engine == EngineStream) ? runStream(options) : runQHull(options);
+
+	if (!options.trace.empty() && !QHullTrace::stop(options.trace))
+		fprintf(stderr, "Failed to write trace to %s\n", options.trace.c_str());
+
+	return result;
+}
@@ -0,0 +1,121 @@
+#ifndef QHULLSTATS_H
+#define QHULLSTATS_H
+
+#include <cstdio>
+#include <cstring>
+
+//! Statistics instrumentation: statements wrapped into QHULL_STAT() are only compiled when QHULL_STATS is defined.
+#ifdef QHULL_STATS
+#define QHULL_STAT(statement) statement
+#else
+#define QHULL_STAT(statement)
+#endif
+
+//! Power of two histogram: bin i counts the values within [2^(i-1), 2^i[, bin 0 counting zeros.
+class QHullHistogram
+{
+public:
+
+	static const int BinCount = 32;
+
+	long long bins[BinCount];
+	long long count;
+	long long sum;
+	long long max;
+
+	QHullHistogram() { clear(); }
+
+	void clear()
+	{
+		memset(bins, 0, sizeof(bins));
+		count = 0;
+		sum = 0;
+		max = 0;
+	}
+
+	void add(long long value)
+	{
+		int bin = 0;
+		while (bin < BinCount - 1 && (value >> bin) != 0)
+			++bin;
+
+		++bins[bin];
+		++count;
+		sum += value;
+		if (value > max)
+			max = value;
+	}
+
+	double mean() const { return count ? (double)sum / count : 0.0; }
+
+	//! Print the non empty bins.
+	void print(FILE* file, const char* name) const
+	{
+		fprintf(file, "%s: mean %.2f, max %lld\n", name, mean(), max);
+		for (int i = 0; i < BinCount; ++i)
+		{
+			if (bins[i])
+				fprintf(file, "  [%lld, %lld[: %lld\n", i ? 1LL << (i - 1) : 0LL, 1LL << i, bins[i]);
+		}
+	}
+};
+
+//! QHull3d build statistics, accumulated by QHULL_STATS builds only (left null otherwise).
+class QHullStats
+{
+public:
+
+	long long iterations;			//! Performed iterations
+	long long visiblefaces;			//! Visible faces removed by the iterations
+	long long horizonedges;			//! Horizon edges extruded by the iterations
+	long long reassignedpoints;		//! Conflict points reassigned from the removed faces to the new ones
+	long long distancetests;		//! Point to face plane distance evaluations
+	long long buckettests;			//! Conflict bucket box to face plane distance evaluations
+	long long bucketresolved;		//! Points assigned or discarded by their bucket's tests alone
+	long long createdfaces;			//! Created faces
+	long long deletedfaces;			//! Deleted faces
+	long long onedgepoints;			//! Extreme points discarded by the on-edge case
+
+	QHullHistogram visiblefaceshistogram;	//! Visible faces per iteration
+	QHullHistogram horizonedgeshistogram;	//! Horizon edges per iteration
+	QHullHistogram reassignedhistogram;		//! Reassigned points per iteration
+
+	QHullStats() { clear(); }
+
+	void clear()
+	{
+		iterations = 0;
+		visiblefaces = 0;
+		horizonedges = 0;
+		reassignedpoints = 0;
+		distancetests = 0;
+		buckettests = 0;
+		bucketresolved = 0;
+		createdfaces = 0;
+		deletedfaces = 0;
+		onedgepoints = 0;
+
+		visiblefaceshistogram.clear();
+		horizonedgeshistogram.clear();
+		reassignedhistogram.clear();
+	}
+
+	//! Print the totals and histograms.
+	void print(FILE* file) const
+	{
+#ifndef QHULL_STATS
+		fprintf(file, "Statistics disabled: build with QHULL_STATS defined\n");
+#else
+		fprintf(file, "iterations %lld\nvisible faces %lld\nhorizon edges %lld\nreassigned points %lld\n"
+			"distance tests %lld\nbucket tests %lld\nbucket resolved points %lld\ncreated faces %lld\ndeleted faces %lld\non edge points %lld\n",
+			iterations, visiblefaces, horizonedges, reassignedpoints,
+			distancetests, buckettests, bucketresolved, createdfaces, deletedfaces, onedgepoints);
+
+		visiblefaceshistogram.print(file, "visible faces per iteration");
+		horizonedgeshistogram.print(file, "horizon edges per iteration");
+		reassignedhistogram.print(file, "reassigned points per iteration");
+#endif
+	}
+};
+
+#endif
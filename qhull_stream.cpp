@@ -0,0 +1,103 @@
+#include "qhull_stream.h"
+
+#include <algorithm>
+
+void QHullStream::add(const gk::Point* points, int count)
+{
+	while (count > 0)
+	{
+		int chunkcount = (int)_points.size() - _hullcount;
+		int n = std::min(count, _chunksize - chunkcount);
+
+		_points.insert(_points.end(), points, points + n);
+		for (int i = 0; i < n; ++i)
+			_indices.push_back(_pointcount++);
+
+		points += n;
+		count -= n;
+
+		if (chunkcount + n == _chunksize)
+			flush();
+	}
+}
+long long QHullStream::build(const Reader& reader)
+{
+	long long pointcount = _pointcount;
+
+	std::vector<gk::Point> buffer(_chunksize);
+
+	int count;
+	while ((count = reader(&buffer[0], _chunksize)) > 0)
+		add(&buffer[0], count);
+
+	flush();
+
+	return _pointcount - pointcount;
+}
+
+void QHullStream::flush()
+{
+	if ((int)_points.size() == _hullcount)
+		return;
+
+	QHULL_TRACE("flush");
+
+	// Too few points to span anything: keep them all
+	if (_points.size() < 4)
+	{
+		_hullcount = (int)_points.size();
+
+		return;
+	}
+
+	// Hull the running hull vertices along with the chunk's points
+	QHull3d qhull;
+	qhull.initialize(&_points[0], (int)_points.size());
+	qhull.build();
+
+	// Failed build (degenerate input): keep all the points, the next flush hulling them again
+	if (qhull.failed())
+	{
+		_hullcount = (int)_points.size();
+		_faces.clear();
+
+		return;
+	}
+
+	// Compact the hull vertices at the beginning of the point set, discarding the interior points
+	std::vector<int> hullindices = qhull.hullVertices();
+
+	// Faces are extracted before the compaction, and reindexed through the sorted hull vertices
+	std::vector<ConvexHull3d::Face> faces;
+	std::vector<int> remap;
+
+	if (_buildfaces)
+	{
+		faces = qhull.hull();
+		remap.resize(_points.size(), -1);
+	}
+
+	for (int i = 0; i < (int)hullindices.size(); ++i)
+	{
+		if (_buildfaces)
+			remap[hullindices[i]] = i;
+
+		_points[i] = _points[hullindices[i]];
+		_indices[i] = _indices[hullindices[i]];
+	}
+
+	_hullcount = (int)hullindices.size();
+
+	_points.resize(_hullcount);
+	_indices.resize(_hullcount);
+
+	// Reindex the faces into the running hull vertices
+	_faces.clear();
+	_faces.reserve(faces.size());
+
+	for (int f = 0; f < (int)faces.size(); ++f)
+		_faces.push_back(ConvexHull3d::Face(
+		remap[faces[f].idx[0]],
+		remap[faces[f].idx[1]],
+		remap[faces[f].idx[2]]));
+}
@@ -0,0 +1,84 @@
+#ifndef QHULLSTREAM_H
+#define QHULLSTREAM_H
+
+#include "qhull_3d.h"
+
+#include <functional>
+#include <vector>
+
+//! Streaming 3D convex hull builder, for point sets too large to be resident.
+//! Points are consumed in fixed-size chunks: each full chunk is hulled along with the running hull vertices,
+//! and only the resulting hull vertices are kept, so memory is O(h + chunk size) whatever the input size.
+class QHullStream
+{
+public:
+
+	//! Point reader: fills the specified buffer with at most count points.
+	//! Returns the number of read points, 0 once the input is exhausted.
+	typedef std::function<int(gk::Point* points, int count)> Reader;
+
+private:
+
+	//! Chunk size.
+	int _chunksize;
+
+	//! Running hull vertices, followed by the current chunk's points.
+	std::vector<gk::Point> _points;
+	//! Input indices of the running hull vertices and current chunk's points.
+	std::vector<long long> _indices;
+	//! Running hull vertex count.
+	int _hullcount;
+
+	//! Running hull faces, indexed into the running hull vertices.
+	std::vector<ConvexHull3d::Face> _faces;
+	//! Build the running hull faces, or only keep the running hull vertices.
+	bool _buildfaces;
+
+	//! Consumed point count.
+	long long _pointcount;
+
+public:
+
+	QHullStream(int chunksize = 1 << 20) : _chunksize(chunksize), _buildfaces(true) { clear(); }
+
+	//! Clear internal data.
+	void clear();
+
+	//! Consume the specified points.
+	void add(const gk::Point* points, int count);
+	//! Consume all the points provided by the specified reader.
+	//! Returns the number of consumed points.
+	long long build(const Reader& reader);
+
+	//! Hull the pending chunk's points, if any.
+	void flush();
+
+	//! Enable or disable the running hull faces: without them, each flush skips the face list altogether.
+	void setBuildFaces(bool buildfaces) { _buildfaces = buildfaces; }
+	//! Get whether the running hull faces are built.
+	bool buildFaces() const { return _buildfaces; }
+
+	//! Get the consumed point count.
+	long long pointCount() const { return _pointcount; }
+
+	//! Get the running hull vertices (pending chunk's points excluded).
+	std::vector<gk::Point> vertices() const { return std::vector<gk::Point>(_points.begin(), _points.begin() + _hullcount); }
+	//! Get the input indices of the running hull vertices.
+	std::vector<long long> vertexIndices() const { return std::vector<long long>(_indices.begin(), _indices.begin() + _hullcount); }
+
+	//! Get the running hull faces, indexed into the running hull vertices (empty unless built).
+	const std::vector<ConvexHull3d::Face>& hull() const { return _faces; }
+};
+
+inline void QHullStream::clear()
+{
+	_points.clear();
+	_indices.clear();
+	_hullcount = 0;
+
+	_faces.clear();
+
+	_pointcount = 0;
+}
+
+#endif
@@ -0,0 +1,98 @@
+#include "qhull_trace.h"
+
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+//! Recorded event.
+struct TraceEvent
+{
+	const char* name;
+	const char* argname;
+	long long arg;
+	long long begin;	//! Microseconds since the recording start
+	long long duration;	//! Microseconds
+	int thread;
+};
+
+static std::atomic<bool> traceenabled(false);
+static std::mutex tracemutex;
+static std::vector<TraceEvent> traceevents;
+static QHullTrace::Clock::time_point tracestart;
+
+//! Get the calling thread's trace identifier (threads are numbered in order of first event).
+static int traceThread()
+{
+	static std::atomic<int> threadcount(0);
+	thread_local int thread = ++threadcount;
+
+	return thread;
+}
+
+void QHullTrace::start()
+{
+	std::lock_guard<std::mutex> lock(tracemutex);
+
+	traceevents.clear();
+	tracestart = Clock::now();
+
+	traceenabled = true;
+}
+bool QHullTrace::stop(const std::string& filename)
+{
+	traceenabled = false;
+
+	std::lock_guard<std::mutex> lock(tracemutex);
+
+	FILE* file = fopen(filename.c_str(), "w");
+	if (!file)
+		return false;
+
+	fprintf(file, "{\"traceEvents\":[\n");
+
+	for (size_t i = 0; i < traceevents.size(); ++i)
+	{
+		const TraceEvent& event = traceevents[i];
+
+		fprintf(file, "{\"name\":\"%s\",\"cat\":\"qhull\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":1,\"tid\":%d",
+			event.name, event.begin, event.duration, event.thread);
+
+		if (event.argname)
+			fprintf(file, ",\"args\":{\"%s\":%lld}", event.argname, event.arg);
+
+		fprintf(file, "}%s\n", (i + 1 < traceevents.size()) ? "," : "");
+	}
+
+	fprintf(file, "],\"displayTimeUnit\":\"ms\"}\n");
+
+	traceevents.clear();
+
+	return fclose(file) == 0;
+}
+
+bool QHullTrace::isEnabled()
+{
+	return traceenabled.load(std::memory_order_relaxed);
+}
+
+void QHullTrace::complete(const char* name, const Clock::time_point& begin, const char* argname, long long arg)
+{
+	if (!isEnabled())
+		return;
+
+	Clock::time_point end = Clock::now();
+
+	TraceEvent event;
+	event.name = name;
+	event.argname = argname;
+	event.arg = arg;
+	event.thread = traceThread();
+
+	std::lock_guard<std::mutex> lock(tracemutex);
+
+	event.begin = std::chrono::duration_cast<std::chrono::microseconds>(begin - tracestart).count();
+	event.duration = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+
+	traceevents.push_back(event);
+}
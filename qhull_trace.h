@@ -0,0 +1,58 @@
+#ifndef QHULLTRACE_H
+#define QHULLTRACE_H
+
+#include <chrono>
+#include <string>
+
+//! Timeline recorder, writing trace_event JSON files (chrome://tracing, Perfetto).
+//! Recording is off until start() is called: disabled trace points only cost a flag test.
+//! Events are recorded as complete events, from any thread.
+class QHullTrace
+{
+public:
+
+	typedef std::chrono::steady_clock Clock;
+
+	//! Start recording, discarding any previously recorded event.
+	static void start();
+	//! Stop recording and write the recorded events into the specified trace file.
+	//! Returns false if the file could not be written.
+	static bool stop(const std::string& filename);
+
+	//! Returns true if events are being recorded.
+	static bool isEnabled();
+
+	//! Record an event, from the specified begin time to now, with an optional integer argument.
+	//! The name and argument name must be string literals (they are not copied).
+	static void complete(const char* name, const Clock::time_point& begin, const char* argname = nullptr, long long arg = 0);
+};
+
+//! Scoped trace event, recorded from its construction to its destruction.
+class QHullTraceScope
+{
+private:
+
+	const char* _name;
+	QHullTrace::Clock::time_point _begin;
+
+public:
+
+	QHullTraceScope(const char* name) : _name(QHullTrace::isEnabled() ? name : nullptr)
+	{
+		if (_name)
+			_begin = QHullTrace::Clock::now();
+	}
+	~QHullTraceScope()
+	{
+		if (_name)
+			QHullTrace::complete(_name, _begin);
+	}
+};
+
+#define QHULL_TRACE_CONCAT2(a, b) a##b
+#define QHULL_TRACE_CONCAT(a, b) QHULL_TRACE_CONCAT2(a, b)
+
+//! Trace the enclosing scope under the specified name.
+#define QHULL_TRACE(name) QHullTraceScope QHULL_TRACE_CONCAT(qhulltracescope, __LINE__)(name)
+
+#endif
@@ -0,0 +1,764 @@
+#ifndef SMALLHULL3D_H
+#define SMALLHULL3D_H
+
+#include "qhull_3d.h"
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#define SMALL_HULL_MAX_COUNT	64
+
+//! Fixed capacity 3D convex hull of at most N points, for tiny inputs where QHull3d's allocations dominate.
+//! Runs the QHull3d algorithm step for step (same simplex, assignment rule, processing order, visibility and on-edge tests),
+//! over index based half-edges stored in place: no allocation and no virtual call, the resulting face set being QHull3d's.
+//! Only volumetric inputs are handled: build() declines empty, singular, linear and planar inputs, left to QHull3d.
+template <int N>
+class SmallHull3d
+{
+	static_assert(N >= 4, "SmallHull3d needs room for a tetrahedron");
+
+private:
+
+	//! Face capacity: the live faces (at most 2N - 4) and the faces extruded by an iteration (at most one per hull vertex).
+	static const int MaxFaces = 3 * N;
+	//! Processing stack capacity, stale entries being compacted away when full.
+	static const int MaxStack = 4 * N;
+
+	//! Half-edge, the half-edges of face f being 3f, 3f + 1 and 3f + 2.
+	struct HullEdge
+	{
+		int vertex;		//! Point at the end of the half-edge
+		int next;		//! Next half-edge around the face
+		int coedge;		//! Oppositely oriented adjacent half-edge
+	};
+
+	//! Face.
+	struct HullFace
+	{
+		int edge;					//! One of the half-edges bordering the face
+		int id;						//! Allocation stamp, telling the stale processing stack entries of recycled faces
+		int iterationid;			//! Iteration identifier
+		bool alive;
+
+		gk::Vector n;				//! Face normal
+		float d;					//! Signed distance to the origin
+		float extremedistance;		//! Furthest conflict point distance
+
+		int first;					//! Conflict list, furthest point first
+		int last;
+	};
+
+	//! Points, gathered in place.
+	gk::Point _points[N];
+	int _pointcount;
+	float _epsilon;
+
+	HullEdge _edges[3 * MaxFaces];
+	HullFace _faces[MaxFaces];
+	int _freefaces[MaxFaces];
+	int _freecount;
+	int _nextid;
+
+	//! Next point of each point's conflict list.
+	int _nextconflict[N];
+
+	//! Processing stack of (face, allocation stamp) pairs.
+	int _stack[MaxStack][2];
+	int _stacksize;
+
+	int _iterationid;
+	//! Set when a capacity is exceeded (numerically inconsistent inputs).
+	bool _failed;
+
+	// Iteration scratch
+	int _visible[MaxFaces];
+	int _visiblecount;
+	int _traversal[MaxFaces][2];
+	int _horizon[N];
+	int _horizoncount;
+	int _newfaces[N];
+
+public:
+
+	SmallHull3d() : _pointcount(0), _epsilon(0.f), _freecount(0), _nextid(0), _stacksize(0), _iterationid(-1), _failed(false) {}
+
+	//! Build the specified points' hull.
+	//! Returns false if the input is not volumetric or exceeds the capacity, the hull being left to QHull3d.
+	bool build(const PointView3d& points, int count);
+
+	//! Get the hull face count.
+	int faceCount() const;
+
+	//! Append the hull faces to the specified ones.
+	void hull(std::vector<ConvexHull3d::Face>& faces) const;
+	//! Get the hull faces.
+	std::vector<ConvexHull3d::Face> hull() const
+	{
+		std::vector<ConvexHull3d::Face> faces;
+		hull(faces);
+
+		return faces;
+	}
+
+private:
+
+	float distance(int f, const gk::Point& p) const
+	{
+		const HullFace& face = _faces[f];
+		return face.n.x * p.x + face.n.y * p.y + face.n.z * p.z + face.d;
+	}
+
+	int next(int e) const { return _edges[e].next; }
+	int vertex(int e) const { return _edges[e].vertex; }
+	int faceOf(int e) const { return e / 3; }
+
+	int createFace();
+	int createFace(int v1idx, int v2idx, int v3idx);
+	void releaseFace(int f);
+
+	void updateSupportPlane(int f);
+	void reverse(int f);
+
+	bool tryAssignVertex(int f, int i);
+	int popExtreme(int f);
+
+	bool createInitialTetrahedron();
+	bool extrude(const int* loop, int count, int vidx, bool inward);
+
+	bool iterate();
+	void getVisibleFaces(int f, const gk::Point& p);
+	bool getHorizonEdgeLoop(const gk::Point& p, bool& onedge);
+	bool isOnEdge(const gk::Point& e1, const gk::Point& e2, const gk::Point& p) const;
+
+	bool pushFace(int f);
+};
+
+/************************************************************************/
+/*								Front-end								*/
+/************************************************************************/
+
+//! Build the specified points' hull faces: through SmallHull3d up to SMALL_HULL_MAX_COUNT points,
+//! through QHull3d for larger inputs and for the degenerate inputs SmallHull3d declines.
+inline std::vector<ConvexHull3d::Face> buildHull3d(const PointView3d& points, int count)
+{
+	std::vector<ConvexHull3d::Face> faces;
+
+	if (count <= 16)
+	{
+		SmallHull3d<16> hull;
+		if (hull.build(points, count))
+		{
+			hull.hull(faces);
+			return faces;
+		}
+	}
+	else if (count <= SMALL_HULL_MAX_COUNT)
+	{
+		SmallHull3d<SMALL_HULL_MAX_COUNT> hull;
+		if (hull.build(points, count))
+		{
+			hull.hull(faces);
+			return faces;
+		}
+	}
+
+	QHull3d qhull;
+	qhull.initialize(points, count);
+	qhull.build();
+
+	return qhull.hull();
+}
+
+/************************************************************************/
+/*								Implementation							*/
+/************************************************************************/
+
+template <int N>
+bool SmallHull3d<N>::build(const PointView3d& points, int count)
+{
+	_pointcount = count;
+	_stacksize = 0;
+	_iterationid = -1;
+	_nextid = 0;
+	_failed = false;
+
+	_freecount = 0;
+	for (int f = MaxFaces - 1; f >= 0; --f)
+	{
+		_faces[f].alive = false;
+		_freefaces[_freecount++] = f;
+	}
+
+	if (count < 4 || count > N)
+		return false;
+
+	if (points.packed())
+		memcpy(_points, points.base(), count * sizeof(gk::Point));
+	else
+	{
+		for (int i = 0; i < count; ++i)
+			_points[i] = points[i];
+	}
+
+	// Distance tolerance, as QHull3d::createVertices()
+	gk::Vector extent;
+
+	for (int i = 0; i < count; ++i)
+	{
+		extent.x = std::max(extent.x, std::fabs(_points[i].x));
+		extent.y = std::max(extent.y, std::fabs(_points[i].y));
+		extent.z = std::max(extent.z, std::fabs(_points[i].z));
+	}
+
+	_epsilon = QHULL_EPSILON_FACTOR * (extent.x + extent.y + extent.z);
+
+	if (!createInitialTetrahedron())
+		return false;
+
+	while (iterate());
+
+	return !_failed;
+}
+
+template <int N>
+int SmallHull3d<N>::faceCount() const
+{
+	int count = 0;
+	for (int f = 0; f < MaxFaces; ++f)
+		count += _faces[f].alive;
+
+	return count;
+}
+
+template <int N>
+void SmallHull3d<N>::hull(std::vector<ConvexHull3d::Face>& faces) const
+{
+	for (int f = 0; f < MaxFaces; ++f)
+	{
+		if (!_faces[f].alive)
+			continue;
+
+		int edge = _faces[f].edge;
+		faces.push_back(ConvexHull3d::Face(vertex(edge), vertex(next(edge)), vertex(next(next(edge)))));
+	}
+}
+
+template <int N>
+int SmallHull3d<N>::createFace()
+{
+	if (_freecount == 0)
+	{
+		_failed = true;
+		return -1;
+	}
+
+	int f = _freefaces[--_freecount];
+	HullFace& face = _faces[f];
+
+	face.id = _nextid++;
+	face.iterationid = -1;
+	face.alive = true;
+	face.extremedistance = 0.f;
+	face.first = -1;
+	face.last = -1;
+
+	return f;
+}
+template <int N>
+int SmallHull3d<N>::createFace(int v1idx, int v2idx, int v3idx)
+{
+	int f = createFace();
+	if (f < 0)
+		return -1;
+
+	// Same wiring as QHull3d::createFace()
+	int edge1 = 3 * f, edge2 = 3 * f + 1, edge3 = 3 * f + 2;
+
+	_edges[edge1] = { v3idx, edge2, -1 };
+	_edges[edge2] = { v1idx, edge3, -1 };
+	_edges[edge3] = { v2idx, edge1, -1 };
+
+	_faces[f].edge = edge3;
+	updateSupportPlane(f);
+
+	return f;
+}
+template <int N>
+void SmallHull3d<N>::releaseFace(int f)
+{
+	_faces[f].alive = false;
+	_freefaces[_freecount++] = f;
+}
+
+template <int N>
+void SmallHull3d<N>::updateSupportPlane(int f)
+{
+	HullFace& face = _faces[f];
+
+	const gk::Point& v1 = _points[vertex(face.edge)];
+	const gk::Point& v2 = _points[vertex(next(face.edge))];
+	const gk::Point& v3 = _points[vertex(next(next(face.edge)))];
+
+	face.n = gk::Normalize(gk::Cross(gk::Vector(v1, v2), gk::Vector(v1, v3)));
+	face.d = -(v1.x * face.n.x + v1.y * face.n.y + v1.z * face.n.z);
+}
+template <int N>
+void SmallHull3d<N>::reverse(int f)
+{
+	HullFace& face = _faces[f];
+
+	int edge3 = face.edge;
+	int edge1 = next(edge3);
+	int edge2 = next(edge1);
+
+	int v1 = vertex(edge2);
+	int v2 = vertex(edge3);
+	int v3 = vertex(edge1);
+
+	_edges[edge3].vertex = v1;
+	_edges[edge3].next = edge2;
+
+	_edges[edge2].vertex = v3;
+	_edges[edge2].next = edge1;
+
+	_edges[edge1].vertex = v2;
+	_edges[edge1].next = edge3;
+
+	face.n *= -1;
+	face.d *= -1;
+}
+
+template <int N>
+bool SmallHull3d<N>::tryAssignVertex(int f, int i)
+{
+	HullFace& face = _faces[f];
+	float d;
+
+	if ((d = distance(f, _points[i])) <= _epsilon)
+		return false;
+
+	if (face.first < 0 || d >= face.extremedistance)
+	{
+		_nextconflict[i] = face.first;
+		face.first = i;
+		if (face.last < 0)
+			face.last = i;
+
+		face.extremedistance = d;
+	}
+	else
+	{
+		_nextconflict[i] = -1;
+		_nextconflict[face.last] = i;
+		face.last = i;
+	}
+
+	return true;
+}
+template <int N>
+int SmallHull3d<N>::popExtreme(int f)
+{
+	HullFace& face = _faces[f];
+
+	int i = face.first;
+	face.first = _nextconflict[i];
+	if (face.first < 0)
+		face.last = -1;
+
+	return i;
+}
+
+template <int N>
+bool SmallHull3d<N>::createInitialTetrahedron()
+{
+	float d;
+	float dmax;
+
+	int epidx[6];
+	int tetraidx[4];
+
+	// Extreme points (EP)
+	for (int i = 0; i < 6; ++i)
+		epidx[i] = 0;
+
+	for (int i = 1; i < _pointcount; ++i)
+	{
+		const gk::Point& p = _points[i];
+
+		if (p.x < _points[epidx[0]].x)
+			epidx[0] = i;
+		if (p.x > _points[epidx[1]].x)
+			epidx[1] = i;
+
+		if (p.y < _points[epidx[2]].y)
+			epidx[2] = i;
+		if (p.y > _points[epidx[3]].y)
+			epidx[3] = i;
+
+		if (p.z < _points[epidx[4]].z)
+			epidx[4] = i;
+		if (p.z > _points[epidx[5]].z)
+			epidx[5] = i;
+	}
+
+	// Most distant EP pair, declining singular inputs
+	dmax = 0.f;
+	tetraidx[0] = tetraidx[1] = epidx[0];
+
+	for (int i = 0; i < 5; ++i)
+	{
+		for (int j = i + 1; j < 6; ++j)
+		{
+			gk::Vector vij(_points[epidx[i]], _points[epidx[j]]);
+
+			if ((d = vij.LengthSquared()) > dmax)
+			{
+				tetraidx[0] = epidx[i];
+				tetraidx[1] = epidx[j];
+
+				dmax = d;
+			}
+		}
+	}
+
+	if (dmax <= _epsilon * _epsilon)
+		return false;
+
+	// Most distant point from the first edge's support line, declining linear inputs
+	dmax = 0.f;
+	tetraidx[2] = -1;
+
+	const gk::Point& t0 = _points[tetraidx[0]];
+	gk::Vector t01(t0, _points[tetraidx[1]]);
+
+	for (int i = 0; i < _pointcount; ++i)
+	{
+		d = gk::Cross(gk::Vector(t0, _points[i]), t01).LengthSquared();
+
+		if (d > dmax)
+		{
+			tetraidx[2] = i;
+
+			dmax = d;
+		}
+	}
+
+	if (dmax <= _epsilon * _epsilon * t01.LengthSquared())
+		return false;
+
+	// Most distant point from the base triangle, declining planar inputs
+	dmax = 0.f;
+	int tetrabase = createFace(tetraidx[0], tetraidx[1], tetraidx[2]);
+
+	for (int i = 0; i < _pointcount; ++i)
+	{
+		if (i == tetraidx[0] || i == tetraidx[1] || i == tetraidx[2])
+			continue;
+
+		if (std::fabs(d = distance(tetrabase, _points[i])) >= std::fabs(dmax))
+		{
+			tetraidx[3] = i;
+
+			dmax = d;
+		}
+	}
+
+	if (std::fabs(dmax) <= _epsilon)
+		return false;
+
+	if (dmax > 0)
+		reverse(tetrabase);
+
+	// Complete the tetrahedron, the base face first
+	int base = _faces[tetrabase].edge;
+	int loop[3] = { base, next(base), next(next(base)) };
+
+	if (!extrude(loop, 3, tetraidx[3], false))
+		return false;
+
+	int tetrafaces[4] = { tetrabase, _newfaces[0], _newfaces[1], _newfaces[2] };
+
+	// Assign the remaining points to the first face they are visible from
+	for (int i = 0; i < _pointcount; ++i)
+	{
+		if (i == tetraidx[0] || i == tetraidx[1] || i == tetraidx[2] || i == tetraidx[3])
+			continue;
+
+		for (int f = 0; f < 4; ++f)
+			if (tryAssignVertex(tetrafaces[f], i))
+				break;
+	}
+
+	for (int f = 0; f < 4; ++f)
+		if (_faces[tetrafaces[f]].first >= 0)
+			pushFace(tetrafaces[f]);
+
+	return true;
+}
+
+template <int N>
+bool SmallHull3d<N>::extrude(const int* loop, int count, int vidx, bool inward)
+{
+	// Same wiring and sewing as QHull3d::extrudeIn() (horizon loops) and QHull3d::extrudeOut() (tetrahedron base)
+	int lastedge = -1;
+	int firstedge = -1;
+
+	for (int i = 0; i < count; ++i)
+	{
+		int edge = loop[i];
+
+		int f = createFace();
+		if (f < 0)
+			return false;
+
+		int edge1 = 3 * f, edge2 = 3 * f + 1, edge3 = 3 * f + 2;
+
+		int v1 = inward ? vertex(next(next(edge))) : vertex(edge);
+		int v2 = inward ? vertex(edge) : vertex(next(next(edge)));
+
+		_edges[edge1] = { vidx, edge2, -1 };
+		_edges[edge2] = { v1, edge3, -1 };
+		_edges[edge3] = { v2, edge1, -1 };
+
+		_faces[f].edge = edge3;
+		updateSupportPlane(f);
+
+		if (inward)
+		{
+			int coedge = _edges[edge].coedge;
+
+			_edges[edge3].coedge = coedge;
+			_edges[coedge].coedge = edge3;
+
+			if (lastedge >= 0)
+			{
+				_edges[lastedge].coedge = edge2;
+				_edges[edge2].coedge = lastedge;
+			}
+			lastedge = edge1;
+
+			if (firstedge < 0)
+				firstedge = edge2;
+		}
+		else
+		{
+			_edges[edge].coedge = edge3;
+			_edges[edge3].coedge = edge;
+
+			if (lastedge >= 0)
+			{
+				_edges[lastedge].coedge = edge1;
+				_edges[edge1].coedge = lastedge;
+			}
+			lastedge = edge2;
+
+			if (firstedge < 0)
+				firstedge = edge1;
+		}
+
+		_newfaces[i] = f;
+	}
+
+	_edges[lastedge].coedge = firstedge;
+	_edges[firstedge].coedge = lastedge;
+
+	return true;
+}
+
+template <int N>
+bool SmallHull3d<N>::iterate()
+{
+	int face = -1;
+
+	// Get the next non-empty face to process, skipping the entries of released faces
+	while (face < 0 || _faces[face].first < 0)
+	{
+		if (_stacksize == 0)
+			return false;
+
+		--_stacksize;
+		face = _stack[_stacksize][0];
+
+		if (!_faces[face].alive || _faces[face].id != _stack[_stacksize][1])
+			face = -1;
+	}
+
+	_faces[face].iterationid = ++_iterationid;
+
+	int extreme = popExtreme(face);
+	const gk::Point& p = _points[extreme];
+
+	getVisibleFaces(face, p);
+
+	bool onedge;
+	if (!getHorizonEdgeLoop(p, onedge))
+		return false;
+
+	// Discard points on edge
+	if (onedge)
+		return true;
+
+	if (!extrude(_horizon, _horizoncount, extreme, true))
+		return false;
+
+	// Assign the visible faces' remaining points to the new faces, then release the visible faces
+	for (int vf = 0; vf < _visiblecount; ++vf)
+	{
+		int oldface = _visible[vf];
+
+		for (int i = _faces[oldface].first, nexti; i >= 0; i = nexti)
+		{
+			nexti = _nextconflict[i];
+
+			for (int nf = 0; nf < _horizoncount; ++nf)
+				if (tryAssignVertex(_newfaces[nf], i))
+					break;
+		}
+	}
+
+	for (int vf = 0; vf < _visiblecount; ++vf)
+		releaseFace(_visible[vf]);
+
+	for (int nf = 0; nf < _horizoncount; ++nf)
+		if (!pushFace(_newfaces[nf]))
+			return false;
+
+	return true;
+}
+
+template <int N>
+void SmallHull3d<N>::getVisibleFaces(int f, const gk::Point& p)
+{
+	// Depth first traversal in QHull3d::getVisibleUnvisitedConnectedFaces() order
+	int depth = 1;
+
+	_visible[0] = f;
+	_visiblecount = 1;
+
+	_traversal[0][0] = f;
+	_traversal[0][1] = 0;
+
+	while (depth > 0)
+	{
+		int current = _traversal[depth - 1][0];
+		int i = _traversal[depth - 1][1]++;
+
+		if (i == 3)
+		{
+			--depth;
+			continue;
+		}
+
+		int edge = _faces[current].edge;
+		while (i-- > 0)
+			edge = next(edge);
+
+		int adjacentface = faceOf(_edges[edge].coedge);
+
+		if (_faces[adjacentface].iterationid == _iterationid)
+			continue;
+
+		if (distance(adjacentface, p) >= 0)
+		{
+			_faces[adjacentface].iterationid = _iterationid;
+			_visible[_visiblecount++] = adjacentface;
+
+			_traversal[depth][0] = adjacentface;
+			_traversal[depth][1] = 0;
+			++depth;
+		}
+	}
+}
+
+template <int N>
+bool SmallHull3d<N>::getHorizonEdgeLoop(const gk::Point& p, bool& onedge)
+{
+	onedge = false;
+	_horizoncount = 0;
+
+	// First horizon edge
+	int start = -1;
+
+	for (int f = 0; f < _visiblecount && start < 0; ++f)
+	{
+		int edge = _faces[_visible[f]].edge;
+		for (int i = 0; i < 3; ++i, edge = next(edge))
+		{
+			if (_faces[faceOf(_edges[edge].coedge)].iterationid != _iterationid)
+			{
+				start = edge;
+				break;
+			}
+		}
+	}
+
+	// Complete the loop, turning around each horizon edge's target vertex until the bordered face is visible
+	int edge = start;
+
+	do
+	{
+		if (isOnEdge(_points[vertex(edge)], _points[vertex(next(next(edge)))], p))
+		{
+			onedge = true;
+			return true;
+		}
+
+		if (_horizoncount == N)
+		{
+			_failed = true;
+			return false;
+		}
+
+		_horizon[_horizoncount++] = edge;
+
+		edge = _edges[edge].coedge;
+		while (_faces[faceOf(edge)].iterationid != _iterationid)
+			edge = _edges[next(next(edge))].coedge;
+	} while (edge != start);
+
+	return true;
+}
+
+template <int N>
+bool SmallHull3d<N>::isOnEdge(const gk::Point& e1, const gk::Point& e2, const gk::Point& p) const
+{
+	gk::Vector n = gk::Cross(e2 - e1, p - e1);
+	return (n.x == 0 && n.y == 0 && n.z == 0 && gk::BBox(e1, e2).Inside(p));
+}
+
+template <int N>
+bool SmallHull3d<N>::pushFace(int f)
+{
+	// Compact the stale entries away when full
+	if (_stacksize == MaxStack)
+	{
+		int size = 0;
+		for (int s = 0; s < _stacksize; ++s)
+		{
+			int face = _stack[s][0];
+			if (_faces[face].alive && _faces[face].id == _stack[s][1])
+			{
+				_stack[size][0] = face;
+				_stack[size][1] = _stack[s][1];
+				++size;
+			}
+		}
+
+		_stacksize = size;
+
+		if (_stacksize == MaxStack)
+		{
+			_failed = true;
+			return false;
+		}
+	}
+
+	_stack[_stacksize][0] = f;
+	_stack[_stacksize][1] = _faces[f].id;
+	++_stacksize;
+
+	return true;
+}
+
+#endif
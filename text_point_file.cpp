@@ -0,0 +1,180 @@
+#include "text_point_file.h"
+#include "mapped_file.h"
+#include "parallel.h"
+#include "qhull_trace.h"
+
+#include <atomic>
+#include <charconv>
+#include <cstdio>
+
+#define TEXT_POINT_FILE_MIN_CHUNK	(1 << 20)
+#define TEXT_POINT_FILE_BUFFER		(1 << 20)
+
+static inline bool isBlank(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+static inline const char* skipBlanks(const char* p, const char* end)
+{
+	while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+		++p;
+
+	return p;
+}
+
+bool TextPointFile::read(const std::string& filename, std::vector<gk::Point>& points, int threadcount)
+{
+	MappedFile file;
+
+	points.clear();
+
+	if (!file.open(filename))
+		return false;
+
+	return parse(file.data(), file.data() + file.size(), points, threadcount);
+}
+
+bool TextPointFile::parse(const char* begin, const char* end, std::vector<gk::Point>& points, int threadcount)
+{
+	// Split the text into newline-aligned chunks
+	int chunkcount = (int)std::min<long long>(threadCount(threadcount), (end - begin) / TEXT_POINT_FILE_MIN_CHUNK + 1);
+
+	std::vector<const char*> chunks(chunkcount + 1);
+
+	chunks[0] = begin;
+	chunks[chunkcount] = end;
+
+	for (int c = 1; c < chunkcount; ++c)
+	{
+		const char* p = std::max(chunks[c - 1], begin + ((end - begin) * c) / chunkcount);
+		while (p < end && *p != '\n')
+			++p;
+
+		chunks[c] = (p < end) ? p + 1 : end;
+	}
+
+	// Count each chunk's non blank lines
+	std::vector<long long> offsets(chunkcount + 1, 0);
+
+	parallelFor(chunkcount, chunkcount, [&](int, long long first, long long last)
+	{
+		QHULL_TRACE("countLines");
+
+		for (long long c = first; c < last; ++c)
+		{
+			long long count = 0;
+			bool blank = true;
+
+			for (const char* p = chunks[c]; p < chunks[c + 1]; ++p)
+			{
+				if (*p == '\n')
+				{
+					count += blank ? 0 : 1;
+					blank = true;
+				}
+				else if (!isBlank(*p))
+				{
+					blank = false;
+				}
+			}
+
+			offsets[c + 1] = count + (blank ? 0 : 1);
+		}
+	});
+
+	for (int c = 0; c < chunkcount; ++c)
+		offsets[c + 1] += offsets[c];
+
+	// Parse each chunk's lines into their final location
+	std::atomic<bool> valid(true);
+
+	points.resize((size_t)offsets[chunkcount]);
+
+	parallelFor(chunkcount, chunkcount, [&](int, long long first, long long last)
+	{
+		QHULL_TRACE("parseLines");
+
+		for (long long c = first; c < last; ++c)
+		{
+			gk::Point* point = points.data() + offsets[c];
+
+			const char* p = chunks[c];
+			const char* chunkend = chunks[c + 1];
+
+			while (p < chunkend)
+			{
+				p = skipBlanks(p, chunkend);
+
+				// Blank line
+				if (p == chunkend || *p == '\n')
+				{
+					++p;
+					continue;
+				}
+
+				for (int i = 0; i < 3; ++i)
+				{
+					p = skipBlanks(p, chunkend);
+
+					std::from_chars_result result = std::from_chars(p, chunkend, (*point)[i]);
+					if (result.ec != std::errc())
+					{
+						valid = false;
+						return;
+					}
+
+					p = result.ptr;
+				}
+
+				p = skipBlanks(p, chunkend);
+				if (p < chunkend && *p != '\n')
+				{
+					valid = false;
+					return;
+				}
+
+				++point;
+				++p;
+			}
+		}
+	});
+
+	if (!valid)
+		points.clear();
+
+	return valid;
+}
+
+bool TextPointFile::write(const std::string& filename, const gk::Point* points, long long count)
+{
+	FILE* file = fopen(filename.c_str(), "wb");
+	if (!file)
+		return false;
+
+	std::vector<char> buffer(TEXT_POINT_FILE_BUFFER);
+
+	// Format into a large buffer, flushed when nearly full (a line is at most 3 * 16 + 3 characters)
+	char* p = &buffer[0];
+	char* bufferend = p + buffer.size() - 64;
+
+	bool success = true;
+
+	for (long long i = 0; i < count && success; ++i)
+	{
+		for (int c = 0; c < 3; ++c)
+		{
+			p = std::to_chars(p, bufferend + 64, points[i][c]).ptr;
+			*p++ = (c < 2) ? ' ' : '\n';
+		}
+
+		if (p >= bufferend || i == count - 1)
+		{
+			size_t size = (size_t)(p - &buffer[0]);
+			success = fwrite(&buffer[0], 1, size, file) == size;
+
+			p = &buffer[0];
+		}
+	}
+
+	return (fclose(file) == 0) && success;
+}
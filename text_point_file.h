@@ -0,0 +1,26 @@
+#ifndef TEXTPOINTFILE_H
+#define TEXTPOINTFILE_H
+
+#include <Geometry.h>
+
+#include <string>
+#include <vector>
+
+//! Text point cloud file: one "x y z" point per line, as written by GLViewer::savePoints().
+//! Files are memory mapped and parsed in parallel over newline-aligned chunks.
+class TextPointFile
+{
+public:
+
+	//! Read the points of the specified file, using the specified thread count (0: all cores).
+	//! Blank lines are ignored. Returns false if the file could not be read or holds a malformed line.
+	static bool read(const std::string& filename, std::vector<gk::Point>& points, int threadcount = 0);
+	//! Parse the points of the specified text, using the specified thread count (0: all cores).
+	static bool parse(const char* begin, const char* end, std::vector<gk::Point>& points, int threadcount = 0);
+
+	//! Write the specified points into a text point file.
+	//! Returns false if the file could not be written.
+	static bool write(const std::string& filename, const gk::Point* points, long long count);
+};
+
+#endif